@@ -0,0 +1,127 @@
+// Predictive AI, see ai.h.
+
+#include <string.h>
+
+#include "ai.h"
+
+const AiParams aiLevels[aiLevelCount] = {
+    {"easy", 14, 30, 0, 160, 0},
+    {"medium", 12, 20, 16, 220, 1},
+    {"hard", 20, 10, 6, 140, 1},
+    {"perfect", aiPaddleSpeed, 5, 0, 0, 1},
+};
+
+const AiParams* findAiLevel(const char* name){
+    for (int i = 0; i < aiLevelCount; i++) {
+        if (strcmp(aiLevels[i].name, name) == 0) {
+            return &aiLevels[i];
+        }
+    }
+    return NULL;
+}
+
+//Paddle y that centers the paddle on a ball at ballY, kept inside the walls
+int paddleTargetFor(int ballY){
+    int y = ballY + (ballSideLength / 2) - (paddleLength / 2);
+    if (y < wallThickness) {
+        return wallThickness;
+    }
+    if (y > screenHeight - wallThickness - paddleLength) {
+        return screenHeight - wallThickness - paddleLength;
+    }
+    return y;
+}
+
+void initAi(AiState* ai, const AiParams* params, unsigned int seed){
+    ai->params = params;
+    ai->lastDirection = (Point){0, 0};
+    ai->lastPosition = initialBallPosition;
+    ai->targetY = initialAiPaddlePosition.y;
+    ai->pendingTargetY = initialAiPaddlePosition.y;
+    ai->delay = 0;
+    ai->noiseOffset = 0;
+    ai->seed = seed;
+}
+
+int predictBallY(const Global* state, int x){
+    int vx = state->ballDirection.x * state->ballSpeed;
+    int vy = state->ballDirection.y * state->ballSpeed;
+    if (vx == 0) {
+        return state->ballPosition.y;
+    }
+
+    //Follow the ball as if there were no walls, then fold the path back into the field. updateBall() turns the
+    //ball around when its top edge gets to wallThickness or screenHeight - wallThickness.
+    long travel = (long) (x - state->ballPosition.x) * vy / vx;
+    long top = wallThickness;
+    long range = screenHeight - 2 * wallThickness;
+    long offset = (state->ballPosition.y - top + travel) % (2 * range);
+    if (offset < 0) {
+        offset += 2 * range;
+    }
+    return (int) (offset <= range ? top + offset : top + 2 * range - offset);
+}
+
+int aiNoise(AiState* ai){
+    if (ai->params->noise <= 0) {
+        return 0;
+    }
+    ai->seed = ai->seed * 1664525u + 1013904223u;
+    return (int) ((ai->seed >> 8) % (2 * ai->params->noise + 1)) - ai->params->noise;
+}
+
+void updatePredictiveAI(Global* state, AiState* ai){
+    const AiParams* params = ai->params;
+    int towardAi = state->ballDirection.x < 0;
+
+    //A paddle hit or a reset: the only times the ball's intercept changes, so the only times to predict.
+    //Wall bounces are already folded into predictBallY().
+    int moved = state->ballPosition.x - ai->lastPosition.x;
+    int reset = state->ballPosition.x == initialBallPosition.x && state->ballPosition.y == initialBallPosition.y
+                && (moved > state->ballSpeed || -moved > state->ballSpeed);
+    if (reset || state->ballDirection.x != ai->lastDirection.x) {
+        ai->noiseOffset = aiNoise(ai);
+        if (params->predict && towardAi) {
+            int y = predictBallY(state, state->aiPaddlePosition.x + paddleWidth) + ai->noiseOffset;
+            ai->pendingTargetY = paddleTargetFor(y);
+        } else if (params->predict) {
+            ai->pendingTargetY = paddleTargetFor(initialBallPosition.y);
+        }
+        ai->delay = params->reactionDelay;
+    }
+    ai->lastDirection = state->ballDirection;
+    ai->lastPosition = state->ballPosition;
+
+    if (!params->predict) {
+        //Track the ball's height while it is on the AI's half, like updateAI() but with the level's limits
+        if (state->ballPosition.x + ballSideLength < screenWidth / 2) {
+            ai->targetY = paddleTargetFor(state->ballPosition.y + ai->noiseOffset);
+        }
+    } else if (ai->delay > 0) {
+        ai->delay--;
+    } else {
+        ai->targetY = ai->pendingTargetY;
+    }
+
+    int distance = ai->targetY - state->aiPaddlePosition.y;
+    if (distance > params->deadZone) {
+        state->aiPaddlePosition.y += distance < params->speed ? distance : params->speed;
+    } else if (distance < -params->deadZone) {
+        state->aiPaddlePosition.y -= -distance < params->speed ? -distance : params->speed;
+    }
+}
+
+void gameLogicWithAI(AiState* ai){
+    if (global.introScreen == 0) {
+        return;
+    }
+
+    if (global.gameOver == 0) {
+        updateBall();
+        updatePredictiveAI(&global, ai);
+    }
+
+    if (global.playerScore >= winningScore || global.aiScore >= winningScore) {
+        global.gameOver = 1;
+    }
+}
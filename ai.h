@@ -0,0 +1,53 @@
+// Predictive AI with difficulty levels.
+// updateAI() chases the ball's current height every tick, and only once the ball is on its half. The AI here
+// instead works out where the ball will be when it reaches the paddle, folding the path at the walls in closed
+// form, and only does so when the ball is served or turns around. In between it just moves toward the cached
+// target. The difficulty comes from how late it reacts to a serve or a paddle hit, how far off its prediction
+// is and how fast the paddle may move.
+
+#ifndef PONG_AI_H
+#define PONG_AI_H
+
+#include "simulation.h"
+
+typedef struct AiParams{
+    const char* name;
+    int speed; //Most pixels the paddle moves per tick
+    int deadZone; //Pixels the paddle center may be off the target before it moves
+    int reactionDelay; //Ticks between the ball turning around (or a serve) and the AI acting on it. Predicting
+                       //levels only, a tracking one follows the ball as it goes.
+    int noise; //Pixels, the AI misjudges the ball by up to this much either way, picked again when the ball turns
+    int predict; //0 tracks the ball's height while it is on the AI's half, 1 goes to the predicted intercept
+} AiParams;
+
+//Difficulty ladder, easiest first
+const int aiLevelCount = 4;
+extern const AiParams aiLevels[aiLevelCount];
+
+typedef struct AiState{
+    const AiParams* params;
+    Point lastDirection; //Ball direction last tick, to notice it turning around
+    Point lastPosition; //Ball position last tick, to notice resets
+    int targetY; //Paddle y the AI is heading for
+    int pendingTargetY; //Predicted target that takes over once the reaction delay has passed
+    int delay; //Ticks left before pendingTargetY takes over
+    int noiseOffset; //How far the AI misjudges the ball since it last turned around
+    unsigned int seed; //For the prediction noise, so a match plays out the same for the same seed
+} AiState;
+
+//Looks up a level by name, NULL if there is none
+const AiParams* findAiLevel(const char* name);
+
+void initAi(AiState* ai, const AiParams* params, unsigned int seed);
+
+//Ball y (top edge) at the moment the ball's left edge reaches x, reflecting off the top and bottom walls the way
+//updateBall() does. If the ball isn't moving horizontally, its current y.
+int predictBallY(const Global* state, int x);
+
+//Moves the AI paddle of state one tick
+void updatePredictiveAI(Global* state, AiState* ai);
+
+//gameLogic() with updatePredictiveAI() in place of updateAI()
+void gameLogicWithAI(AiState* ai);
+
+#endif //PONG_AI_H
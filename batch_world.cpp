@@ -0,0 +1,308 @@
+// Batched simulation of many independent matches, see batch_world.h.
+// The step kernel is written once against a small vector interface (VecScalar, VecSSE2, VecAVX2) and every
+// if-statement of updateBall/updateAI/resetBall is turned into a lane mask, so lanes never branch.
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "batch_world.h"
+
+//Number of int arrays in BatchWorld, and the widest vector we step with (in lanes).
+//capacity is always a multiple of maxVectorWidth, so every array starts on a 32 byte boundary.
+const int batchFieldCount = 12;
+const int maxVectorWidth = 8;
+
+//Scalar fallback. Masks are 0 or -1 like the SIMD compare instructions produce, so this is still branch-free.
+struct VecScalar{
+    typedef int Type;
+    enum { width = 1 };
+    static Type load(const int* p){ return *p; }
+    static void store(int* p, Type a){ *p = a; }
+    static Type set1(int a){ return a; }
+    static Type add(Type a, Type b){ return a + b; }
+    static Type sub(Type a, Type b){ return a - b; }
+    static Type mul(Type a, Type b){ return a * b; }
+    static Type gt(Type a, Type b){ return -(int) (a > b); }
+    static Type eq(Type a, Type b){ return -(int) (a == b); }
+    static Type and_(Type a, Type b){ return a & b; }
+    static Type or_(Type a, Type b){ return a | b; }
+    static Type xor_(Type a, Type b){ return a ^ b; }
+    static Type select(Type mask, Type a, Type b){ return (mask & a) | (~mask & b); }
+};
+
+#if defined(__SSE2__)
+struct VecSSE2{
+    typedef __m128i Type;
+    enum { width = 4 };
+    static Type load(const int* p){ return _mm_load_si128((const __m128i*) p); }
+    static void store(int* p, Type a){ _mm_store_si128((__m128i*) p, a); }
+    static Type set1(int a){ return _mm_set1_epi32(a); }
+    static Type add(Type a, Type b){ return _mm_add_epi32(a, b); }
+    static Type sub(Type a, Type b){ return _mm_sub_epi32(a, b); }
+    static Type mul(Type a, Type b){
+#if defined(__SSE4_1__)
+        return _mm_mullo_epi32(a, b);
+#else
+        //SSE2 only multiplies the even lanes, so do even and odd lanes separately and interleave the low halves
+        __m128i even = _mm_mul_epu32(a, b);
+        __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                  _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+#endif
+    }
+    static Type gt(Type a, Type b){ return _mm_cmpgt_epi32(a, b); }
+    static Type eq(Type a, Type b){ return _mm_cmpeq_epi32(a, b); }
+    static Type and_(Type a, Type b){ return _mm_and_si128(a, b); }
+    static Type or_(Type a, Type b){ return _mm_or_si128(a, b); }
+    static Type xor_(Type a, Type b){ return _mm_xor_si128(a, b); }
+    static Type select(Type mask, Type a, Type b){ return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b)); }
+};
+#endif
+
+#if defined(__AVX2__)
+struct VecAVX2{
+    typedef __m256i Type;
+    enum { width = 8 };
+    static Type load(const int* p){ return _mm256_load_si256((const __m256i*) p); }
+    static void store(int* p, Type a){ _mm256_store_si256((__m256i*) p, a); }
+    static Type set1(int a){ return _mm256_set1_epi32(a); }
+    static Type add(Type a, Type b){ return _mm256_add_epi32(a, b); }
+    static Type sub(Type a, Type b){ return _mm256_sub_epi32(a, b); }
+    static Type mul(Type a, Type b){ return _mm256_mullo_epi32(a, b); }
+    static Type gt(Type a, Type b){ return _mm256_cmpgt_epi32(a, b); }
+    static Type eq(Type a, Type b){ return _mm256_cmpeq_epi32(a, b); }
+    static Type and_(Type a, Type b){ return _mm256_and_si256(a, b); }
+    static Type or_(Type a, Type b){ return _mm256_or_si256(a, b); }
+    static Type xor_(Type a, Type b){ return _mm256_xor_si256(a, b); }
+    static Type select(Type mask, Type a, Type b){ return _mm256_blendv_epi8(b, a, mask); }
+};
+#endif
+
+//PONG_BATCH_SCALAR forces the scalar kernel, e.g. to compare it against the SIMD ones with pong_headless --verify
+#if defined(PONG_BATCH_SCALAR)
+typedef VecScalar BatchVec;
+#elif defined(__AVX2__)
+typedef VecAVX2 BatchVec;
+#elif defined(__SSE2__)
+typedef VecSSE2 BatchVec;
+#else
+typedef VecScalar BatchVec;
+#endif
+
+template<class V>
+int stepLanes(BatchWorld* world){
+    typedef typename V::Type T;
+    const T zero = V::set1(0);
+    const T one = V::set1(1);
+    const T allOnes = V::set1(-1);
+    const T side = V::set1(ballSideLength);
+    const T length = V::set1(paddleLength);
+    const T width = V::set1(paddleWidth);
+    const T playerX1 = V::set1(initialPlayerPaddlePosition.x);
+    const T playerX2 = V::add(playerX1, width);
+    const T aiX1 = V::set1(initialAiPaddlePosition.x);
+    const T aiX2 = V::add(aiX1, width);
+    const T ceiling = V::set1(0 + wallThickness);
+    const T floor = V::set1(screenHeight - wallThickness);
+    const T leftWall = V::set1(0 + wallThickness);
+    const T rightWall = V::set1(screenWidth - wallThickness);
+    const T goalTop = V::set1(goalPosition - (goalHeight / 2));
+    const T goalBottom = V::set1(goalPosition + (goalHeight / 2));
+    const T midPoint = V::set1(screenWidth >> 1);
+    const T aiSpeed = V::set1(aiPaddleSpeed);
+    const T deadZone = V::set1(initialBallSpeed);
+    const T lastPoint = V::set1(winningScore - 1);
+    T running = zero;
+
+    for (int i = 0; i < world->capacity; i += V::width) {
+        T ballX = V::load(world->ballX + i);
+        T ballY = V::load(world->ballY + i);
+        T directionX = V::load(world->ballDirectionX + i);
+        T directionY = V::load(world->ballDirectionY + i);
+        T speed = V::load(world->ballSpeed + i);
+        T playerY = V::load(world->playerPaddleY + i);
+        T aiY = V::load(world->aiPaddleY + i);
+        T playerScore = V::load(world->playerScore + i);
+        T aiScore = V::load(world->aiScore + i);
+        T lastScore = V::load(world->lastScore + i);
+        T gameOver = V::load(world->gameOver + i);
+        T ticks = V::load(world->ticks + i);
+        T active = V::eq(gameOver, zero);
+
+        //updateBall: paddle collisions, a <= b is written as !(a > b)
+        T ballX2 = V::add(ballX, side);
+        T ballY2 = V::add(ballY, side);
+        T playerY2 = V::add(playerY, length);
+        T aiY2 = V::add(aiY, length);
+        T playerCollisionY = V::or_(V::xor_(V::or_(V::gt(playerY, ballY), V::gt(ballY, playerY2)), allOnes),
+                                    V::xor_(V::or_(V::gt(playerY, ballY2), V::gt(ballY2, playerY2)), allOnes));
+        T playerCollisionX = V::or_(V::xor_(V::or_(V::gt(playerX1, ballX), V::gt(ballX, playerX2)), allOnes),
+                                    V::xor_(V::or_(V::gt(playerX1, ballX2), V::gt(ballX2, playerX2)), allOnes));
+        T aiCollisionY = V::or_(V::xor_(V::or_(V::gt(aiY, ballY), V::gt(ballY, aiY2)), allOnes),
+                                V::xor_(V::or_(V::gt(aiY, ballY2), V::gt(ballY2, aiY2)), allOnes));
+        T aiCollisionX = V::or_(V::xor_(V::or_(V::gt(aiX1, ballX), V::gt(ballX, aiX2)), allOnes),
+                                V::xor_(V::or_(V::gt(aiX1, ballX2), V::gt(ballX2, aiX2)), allOnes));
+        T paddleCollision = V::or_(V::and_(playerCollisionX, playerCollisionY), V::and_(aiCollisionX, aiCollisionY));
+        T newDirectionX = V::select(paddleCollision, V::sub(zero, directionX), directionX);
+
+        //wall collisions
+        T pastCeiling = V::xor_(V::gt(ballY, ceiling), allOnes);
+        T pastFloor = V::xor_(V::gt(floor, ballY), allOnes);
+        T pastLWall = V::xor_(V::gt(ballX, leftWall), allOnes);
+        T pastRWall = V::xor_(V::gt(rightWall, ballX), allOnes);
+        T newDirectionY = V::select(V::or_(pastCeiling, pastFloor), V::sub(zero, directionY), directionY);
+        newDirectionX = V::select(V::or_(pastLWall, pastRWall), V::sub(zero, newDirectionX), newDirectionX);
+        T clampedY = V::select(pastCeiling, ceiling, V::select(pastFloor, floor, ballY));
+
+        //goal collisions, checked against the position at the start of the tick like updateBall does
+        T inGoalY1 = V::xor_(V::or_(V::gt(goalTop, ballY), V::gt(ballY, goalBottom)), allOnes);
+        T inGoalY2 = V::xor_(V::or_(V::gt(goalTop, ballY2), V::gt(ballY2, goalBottom)), allOnes);
+        T inGoal = V::and_(inGoalY1, inGoalY2);
+        T playerGoal = V::and_(inGoal, pastLWall);
+        T aiGoal = V::and_(V::xor_(playerGoal, allOnes), V::and_(inGoal, pastRWall));
+        T goal = V::or_(playerGoal, aiGoal);
+        T newPlayerScore = V::sub(playerScore, playerGoal);
+        T newAiScore = V::sub(aiScore, aiGoal);
+        T newLastScore = V::select(playerGoal, one, V::select(aiGoal, zero, lastScore));
+
+        //resetBall on a goal, otherwise move the ball.
+        //resetBall passes initialBallDirection.x for the y direction as well, keep that quirk.
+        T resetDirectionX = V::select(V::eq(newLastScore, zero), V::set1(-initialBallDirection.x), V::set1(initialBallDirection.x));
+        T newBallX = V::select(goal, V::set1(initialBallPosition.x), V::add(ballX, V::mul(newDirectionX, speed)));
+        T newBallY = V::select(goal, V::set1(initialBallPosition.y), V::add(clampedY, V::mul(newDirectionY, speed)));
+        newDirectionX = V::select(goal, resetDirectionX, newDirectionX);
+        newDirectionY = V::select(goal, V::set1(initialBallDirection.x), newDirectionY);
+        T newSpeed = V::select(goal, V::set1(initialBallSpeed), speed);
+
+        //updateAI: only tracks when the ball is on the AI's half, with a dead zone of initialBallSpeed
+        T aiActive = V::gt(midPoint, V::add(newBallX, side));
+        T distance = V::sub(V::sub(V::add(newBallY, V::set1(ballSideLength >> 1)), V::set1(paddleLength >> 1)), aiY);
+        T aiDown = V::and_(aiActive, V::gt(distance, deadZone));
+        T aiUp = V::and_(aiActive, V::gt(V::sub(zero, deadZone), distance));
+        T newAiY = V::sub(V::add(aiY, V::and_(aiDown, aiSpeed)), V::and_(aiUp, aiSpeed));
+
+        //gameLogic: only running matches are updated, and they end once someone reaches winningScore
+        newPlayerScore = V::select(active, newPlayerScore, playerScore);
+        newAiScore = V::select(active, newAiScore, aiScore);
+        T finished = V::or_(V::gt(newPlayerScore, lastPoint), V::gt(newAiScore, lastPoint));
+        T newGameOver = V::select(finished, one, gameOver);
+
+        V::store(world->ballX + i, V::select(active, newBallX, ballX));
+        V::store(world->ballY + i, V::select(active, newBallY, ballY));
+        V::store(world->ballDirectionX + i, V::select(active, newDirectionX, directionX));
+        V::store(world->ballDirectionY + i, V::select(active, newDirectionY, directionY));
+        V::store(world->ballSpeed + i, V::select(active, newSpeed, speed));
+        V::store(world->aiPaddleY + i, V::select(active, newAiY, aiY));
+        V::store(world->playerScore + i, newPlayerScore);
+        V::store(world->aiScore + i, newAiScore);
+        V::store(world->lastScore + i, V::select(active, newLastScore, lastScore));
+        V::store(world->gameOver + i, newGameOver);
+        V::store(world->ticks + i, V::sub(ticks, active));
+        running = V::sub(running, V::eq(newGameOver, zero));
+    }
+
+    int lanes[V::width];
+    memcpy(lanes, &running, sizeof(lanes));
+    int total = 0;
+    for (int i = 0; i < V::width; i++) {
+        total += lanes[i];
+    }
+    return total;
+}
+
+void initBatchWorld(BatchWorld* world, int count){
+    int capacity = (count + maxVectorWidth - 1) / maxVectorWidth * maxVectorWidth;
+    size_t arrayBytes = (size_t) capacity * sizeof(int);
+    world->memory = malloc(arrayBytes * batchFieldCount + 32);
+    char* base = (char*) (((uintptr_t) world->memory + 31) & ~(uintptr_t) 31);
+    int** fields[batchFieldCount] = {
+        &world->ballX, &world->ballY, &world->ballDirectionX, &world->ballDirectionY, &world->ballSpeed,
+        &world->playerPaddleY, &world->aiPaddleY, &world->playerScore, &world->aiScore, &world->lastScore,
+        &world->gameOver, &world->ticks
+    };
+    for (int f = 0; f < batchFieldCount; f++) {
+        *fields[f] = (int*) (base + arrayBytes * f);
+    }
+    world->count = count;
+    world->capacity = capacity;
+
+    for (int lane = 0; lane < capacity; lane++) {
+        resetBatchLane(world, lane);
+        //Padding lanes stay finished so they never change and are never counted as running
+        if (lane >= count) {
+            world->gameOver[lane] = 1;
+        }
+    }
+}
+
+void freeBatchWorld(BatchWorld* world){
+    free(world->memory);
+    memset(world, 0, sizeof(BatchWorld));
+}
+
+void resetBatchLane(BatchWorld* world, int lane){
+    world->ballX[lane] = initialBallPosition.x;
+    world->ballY[lane] = initialBallPosition.y;
+    world->ballDirectionX[lane] = initialBallDirection.x;
+    world->ballDirectionY[lane] = initialBallDirection.y;
+    world->ballSpeed[lane] = initialBallSpeed;
+    world->playerPaddleY[lane] = initialPlayerPaddlePosition.y;
+    world->aiPaddleY[lane] = initialAiPaddlePosition.y;
+    world->playerScore[lane] = 0;
+    world->aiScore[lane] = 0;
+    world->lastScore[lane] = 0;
+    world->gameOver[lane] = 0;
+    world->ticks[lane] = 0;
+}
+
+void loadBatchLane(BatchWorld* world, int lane, const Global* state){
+    world->ballX[lane] = state->ballPosition.x;
+    world->ballY[lane] = state->ballPosition.y;
+    world->ballDirectionX[lane] = state->ballDirection.x;
+    world->ballDirectionY[lane] = state->ballDirection.y;
+    world->ballSpeed[lane] = state->ballSpeed;
+    world->playerPaddleY[lane] = state->playerPaddlePosition.y;
+    world->aiPaddleY[lane] = state->aiPaddlePosition.y;
+    world->playerScore[lane] = state->playerScore;
+    world->aiScore[lane] = state->aiScore;
+    world->lastScore[lane] = state->lastScore;
+    world->gameOver[lane] = state->gameOver;
+}
+
+void storeBatchLane(const BatchWorld* world, int lane, Global* state){
+    state->playerPaddlePosition = (Point){initialPlayerPaddlePosition.x, world->playerPaddleY[lane]};
+    state->aiPaddlePosition = (Point){initialAiPaddlePosition.x, world->aiPaddleY[lane]};
+    state->playerScore = world->playerScore[lane];
+    state->aiScore = world->aiScore[lane];
+    state->ballPosition = (Point){world->ballX[lane], world->ballY[lane]};
+    state->ballSpeed = world->ballSpeed[lane];
+    state->ballDirection = (Point){world->ballDirectionX[lane], world->ballDirectionY[lane]};
+    state->lastScore = world->lastScore[lane];
+    state->gameOver = world->gameOver[lane];
+    state->introScreen = 1;
+}
+
+int stepBatchWorld(BatchWorld* world, const int* mouseY){
+    //mouse(): centers the player paddle on the mouse. Applied to every lane, like the GLUT callback would be.
+    for (int lane = 0; lane < world->count; lane++) {
+        world->playerPaddleY[lane] = mouseY[lane] - (paddleLength >> 1);
+    }
+    return stepLanes<BatchVec>(world);
+}
+
+const char* batchWorldIsa(){
+#if defined(PONG_BATCH_SCALAR)
+    return "scalar";
+#elif defined(__AVX2__)
+    return "avx2";
+#elif defined(__SSE2__)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,49 @@
+// Batched simulation of many independent matches.
+// The state of every match is stored in struct-of-arrays layout (one array per field, one lane per match),
+// and stepBatchWorld advances all lanes with a branch-free kernel that is vectorized with AVX2 or SSE2 when
+// the compiler targets them, and falls back to scalar code otherwise.
+// Stepping a lane gives exactly the same result as mouse() followed by gameLogic() on a Global holding that lane.
+
+#ifndef PONG_BATCH_WORLD_H
+#define PONG_BATCH_WORLD_H
+
+#include "simulation.h"
+
+typedef struct BatchWorld{
+    int count; //Number of matches
+    int capacity; //count rounded up to a whole number of SIMD vectors
+    //One entry per lane. The paddle x positions never change during a match, so only y is stored.
+    int* ballX;
+    int* ballY;
+    int* ballDirectionX;
+    int* ballDirectionY;
+    int* ballSpeed;
+    int* playerPaddleY;
+    int* aiPaddleY;
+    int* playerScore;
+    int* aiScore;
+    int* lastScore;
+    int* gameOver;
+    int* ticks; //Ticks played by each match, stops counting once the match is over
+    void* memory; //Backing allocation for all of the arrays above
+} BatchWorld;
+
+//Allocates a world of count matches, all at the initial game state
+void initBatchWorld(BatchWorld* world, int count);
+void freeBatchWorld(BatchWorld* world);
+
+//Puts one lane back to the initial game state
+void resetBatchLane(BatchWorld* world, int lane);
+
+//Copies one lane to or from a Global, e.g. to compare against the scalar path
+void loadBatchLane(BatchWorld* world, int lane, const Global* state);
+void storeBatchLane(const BatchWorld* world, int lane, Global* state);
+
+//Advances every lane by one tick. mouseY holds the mouse y coordinate of each lane (world->count entries).
+//Returns the number of matches that are still running after the step.
+int stepBatchWorld(BatchWorld* world, const int* mouseY);
+
+//Name of the instruction set the step kernel was compiled for ("avx2", "sse2" or "scalar")
+const char* batchWorldIsa();
+
+#endif //PONG_BATCH_WORLD_H
@@ -0,0 +1,621 @@
+// Microbenchmarks.
+// Times the simulation kernels one call at a time from fixed game states, and whole frames of draw() rendered
+// into an offscreen OpenGL context and with the software renderer, and prints the results as JSON so runs of
+// different versions can be compared. OpenGL frames are rendered with Mesa's software rasterizer by default, so
+// the numbers don't depend on a GPU and the benchmark runs on machines without one.
+//
+// --verify instead checks that the software renderer's frames match the OpenGL ones pixel for pixel.
+
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "batch_world.h"
+#include "font_data.h"
+#include "game_view.h"
+#include "gl_functions.h"
+#include "offscreen_context.h"
+#include "profiler.h"
+#include "rollback.h"
+#include "game_config.h"
+#include "simulation_kernels.h"
+#include "chaos.h"
+#include "simulation.h"
+#include "soft_renderer.h"
+#include "telemetry.h"
+#include "vector_env.h"
+
+typedef struct BenchResult{
+    const char* name;
+    const char* unit; //"ns" per call, or "ms" per frame
+    long iterations; //Per repetition
+    double median;
+    double min;
+} BenchResult;
+
+std::vector<BenchResult> results;
+const char* filter = NULL; //Only run benchmarks whose name contains this
+int repetitions = 7;
+long kernelIterations = 2000000;
+int frameCount = 60;
+
+//Sinks, so the optimizer can't drop the calls being timed
+volatile float floatSink;
+volatile int intSink;
+
+int selected(const char* name){
+    return !filter || strstr(name, filter) != NULL;
+}
+
+double secondsNow(){
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void addResult(const char* name, const char* unit, long iterations, std::vector<double>& samples){
+    std::sort(samples.begin(), samples.end());
+    results.push_back((BenchResult){name, unit, iterations, samples[samples.size() / 2], samples[0]});
+    fprintf(stderr, "%-28s %10.2f %s (min %.2f)\n", name, samples[samples.size() / 2], unit, samples[0]);
+}
+
+//States the kernels are timed from
+Global benchState(int ballX, int ballY, int directionX){
+    initGlobals();
+    Global state = global;
+    state.introScreen = 1;
+    state.ballPosition = (Point){ballX, ballY};
+    state.ballDirection = (Point){directionX, 1};
+    return state;
+}
+
+//Times kernel called from state, which is put back in global before every call. Every result includes putting
+//it back; restore_only times just that and is reported as a baseline, nothing is subtracted from the others.
+void benchKernel(const char* name, const Global* state, void (*kernel)()){
+    if (!selected(name)) {
+        return;
+    }
+    std::vector<double> samples;
+    for (int r = 0; r < repetitions; r++) {
+        double start = secondsNow();
+        for (long i = 0; i < kernelIterations; i++) {
+            global = *state;
+            kernel();
+        }
+        samples.push_back((secondsNow() - start) * 1e9 / kernelIterations);
+    }
+    addResult(name, "ns", kernelIterations, samples);
+}
+
+void restoreOnly(){
+    intSink = global.ballPosition.x;
+}
+
+//What a rollback session does to take a snapshot and go back to it
+Global snapshotRing[rollbackWindow];
+void snapshotRestore(){
+    int slot = global.ballPosition.x & (rollbackWindow - 1);
+    snapshotRing[slot] = global;
+    global = snapshotRing[slot ^ 1];
+}
+
+void mouseKernel(){
+    mouse(0, global.ballPosition.y);
+}
+
+//The two versions of each kernel, called the same way
+void portableResetBallKernel(){
+    portableResetBall(&global);
+}
+void portableUpdateAIKernel(){
+    portableUpdateAI(&global);
+}
+void portableMouseKernel(){
+    portableMouse(&global, global.ballPosition.y);
+}
+#ifdef PONG_HAS_ASM_KERNELS
+void asmMouseKernel(){
+    asmMouse(0, global.ballPosition.y);
+}
+#endif
+
+//Times updateAI on each of states states in turn, per state: the portable kernel inlined into the loop, or
+//the asm one on global, which every state has to be copied in and out of
+void benchBatchedAI(const char* name, int states, int portable){
+    if (!selected(name)) {
+        return;
+    }
+    std::vector<Global> batch(states);
+    for (int i = 0; i < states; i++) {
+        batch[i] = benchState(400 - (i % 7) * 40, 100 + (i * 37) % (screenHeight - 200), -1);
+        batch[i].aiPaddlePosition.y = (i * 53) % (screenHeight - paddleLength);
+    }
+    long rounds = kernelIterations / states + 1;
+    std::vector<double> samples;
+    for (int r = 0; r < repetitions; r++) {
+        double start = secondsNow();
+        for (long n = 0; n < rounds; n++) {
+            for (int i = 0; i < states; i++) {
+#ifdef PONG_HAS_ASM_KERNELS
+                if (!portable) {
+                    global = batch[i];
+                    asmUpdateAI();
+                    batch[i] = global;
+                    continue;
+                }
+#endif
+                portableUpdateAI(&batch[i]);
+            }
+        }
+        samples.push_back((secondsNow() - start) * 1e9 / (rounds * states));
+    }
+    intSink = batch[0].aiPaddlePosition.y;
+    addResult(name, "ns", rounds * states, samples);
+}
+
+void benchPixelToScreen(const char* name, float (*convert)(int)){
+    if (!selected(name)) {
+        return;
+    }
+    std::vector<double> samples;
+    for (int r = 0; r < repetitions; r++) {
+        double start = secondsNow();
+        for (long i = 0; i < kernelIterations; i++) {
+            floatSink = convert((int) (i & 1023));
+        }
+        samples.push_back((secondsNow() - start) * 1e9 / kernelIterations);
+    }
+    addResult(name, "ns", kernelIterations, samples);
+}
+
+//Times one stepVectorEnv of games games, per game, with every paddle following the ball
+void benchVectorEnv(const char* name, int games){
+    if (!selected(name)) {
+        return;
+    }
+    VectorEnv env;
+    initVectorEnv(&env, games, 0);
+    std::vector<float> observations(games * envObservationSize);
+    std::vector<float> rewards(games);
+    std::vector<int> actions(games);
+    EnvStep step = {observations.data(), rewards.data(), NULL, NULL, NULL};
+    resetVectorEnv(&env, observations.data());
+    long steps = kernelIterations / games + 1;
+    std::vector<double> samples;
+    for (int r = 0; r < repetitions; r++) {
+        double start = secondsNow();
+        for (long i = 0; i < steps; i++) {
+            for (int g = 0; g < games; g++) {
+                actions[g] = (int) (observations[g * envObservationSize + 1] * screenHeight);
+            }
+            stepVectorEnv(&env, actions.data(), &step);
+        }
+        samples.push_back((secondsNow() - start) * 1e9 / (steps * games));
+    }
+    freeVectorEnv(&env);
+    addResult(name, "ns", steps * games, samples);
+}
+
+//Times a cycle of a rollback session: 8 ticks run on predictions, then the remote inputs of those ticks arrive.
+//With correct set, they differ from the predictions, so the 8 ticks are resimulated.
+void benchRollback(const char* name, int correct){
+    if (!selected(name)) {
+        return;
+    }
+    const int cycleTicks = 8;
+    Global start = benchState(900, 500, 1);
+    RollbackSession session;
+    initRollback(&session, ROLLBACK_RIGHT, &start);
+    long cycles = kernelIterations / cycleTicks;
+    std::vector<double> samples;
+    for (int r = 0; r < repetitions; r++) {
+        double begin = secondsNow();
+        for (long i = 0; i < cycles; i++) {
+            long first = session.tick;
+            for (int t = 0; t < cycleTicks; t++) {
+                advanceRollback(&session, scriptedPlayerY(session.tick) - paddleLength / 2);
+            }
+            for (int t = 0; t < cycleTicks; t++) {
+                int32_t remote = correct ? scriptedPlayerY(first + t + 7919) - paddleLength / 2 : session.predictedInput;
+                addRemoteInput(&session, first + t, remote);
+            }
+            acknowledgeRollback(&session, session.tick);
+            settleRollback(&session);
+            if (session.state.gameOver) {
+                session.state = start;
+            }
+        }
+        samples.push_back((secondsNow() - begin) * 1e9 / cycles);
+    }
+    intSink = session.state.ballPosition.x;
+    addResult(name, "ns", cycles, samples);
+}
+
+//Times whole matches played through playArenaMatch with arena, per tick
+template <class Arena>
+void benchArena(const char* name, const Arena& arena){
+    if (!selected(name)) {
+        return;
+    }
+    long ticks = 0;
+    std::vector<double> samples;
+    for (int r = 0; r < repetitions; r++) {
+        ticks = 0;
+        double start = secondsNow();
+        for (long m = 0; ticks < kernelIterations; m++) {
+            Global state;
+            ticks += playArenaMatch(arena, &state, m * 37, kernelIterations);
+            intSink = state.aiScore;
+        }
+        samples.push_back((secondsNow() - start) * 1e9 / ticks);
+    }
+    addResult(name, "ns", ticks, samples);
+}
+
+//Times stepChaosWorld with balls balls and the standard obstacles, per tick. The world keeps going from one
+//repetition to the next, so later ones also see balls that have been served again.
+void benchChaos(const char* name, int balls, int bruteForce){
+    if (!selected(name)) {
+        return;
+    }
+    ChaosWorld world;
+    initChaosWorld(&world, balls, 16);
+    fillChaosWorld(&world, balls, 308);
+    world.bruteForce = bruteForce;
+    long ticks = kernelIterations / 10 / balls + 5;
+    std::vector<double> samples;
+    for (int r = 0; r < repetitions; r++) {
+        double start = secondsNow();
+        for (long t = 0; t < ticks; t++) {
+            stepChaosWorld(&world, scriptedPlayerY(world.ticks));
+        }
+        samples.push_back((secondsNow() - start) * 1e6 / ticks);
+    }
+    intSink = world.playerScore;
+    freeChaosWorld(&world);
+    addResult(name, "us", ticks, samples);
+}
+
+//Times pushTelemetry with the writer running and encoding into /dev/null. Pushes come much faster than ticks
+//do, so some of them find the ring full; those are timed too, as they are in the game.
+void benchTelemetry(const char* name){
+    if (!selected(name)) {
+        return;
+    }
+    TelemetryLog log;
+    if (startTelemetry(&log, "/dev/null") != 0) {
+        return;
+    }
+    Global state = benchState(900, 500, 1);
+    TelemetryRecord record;
+    makeTelemetryRecord(&record, 0, &state, &state);
+    std::vector<double> samples;
+    for (int r = 0; r < repetitions; r++) {
+        double start = secondsNow();
+        for (long i = 0; i < kernelIterations; i++) {
+            record.tick = i;
+            record.ballX = (int32_t) (i & 1023);
+            pushTelemetry(&log, &record);
+        }
+        samples.push_back((secondsNow() - start) * 1e9 / kernelIterations);
+    }
+    finishTelemetry(&log);
+    addResult(name, "ns", kernelIterations, samples);
+}
+
+void runKernelBenchmarks(){
+    Global freeFlight = benchState(900, 500, 1);
+    //Ball overlapping the player paddle, which sits in the middle at the start
+    Global paddleHit = benchState(initialPlayerPaddlePosition.x - 10, initialPlayerPaddlePosition.y + 50, 1);
+    Global wallBounce = benchState(900, wallThickness - 5, 1);
+    Global goal = benchState(screenWidth - wallThickness + 5, goalPosition - ballSideLength / 2, 1);
+    //On the AI's half, far below the paddle, so the AI moves
+    Global aiTracking = benchState(400, screenHeight - 200, -1);
+    Global aiIdle = benchState(1400, 500, 1);
+
+    benchKernel("restore_only", &freeFlight, restoreOnly);
+    benchKernel("updateBall/free_flight", &freeFlight, updateBall);
+    benchKernel("updateBall/paddle_hit", &paddleHit, updateBall);
+    benchKernel("updateBall/wall_bounce", &wallBounce, updateBall);
+    benchKernel("updateBall/goal", &goal, updateBall);
+    benchKernel("updateAI/tracking", &aiTracking, updateAI);
+    benchKernel("updateAI/idle", &aiIdle, updateAI);
+    benchKernel("resetBall", &freeFlight, resetBall);
+    benchKernel("mouse", &freeFlight, mouseKernel);
+    benchKernel("gameLogic", &freeFlight, gameLogic);
+    benchPixelToScreen("pixelToScreenX", pixelToScreenX);
+    benchPixelToScreen("pixelToScreenY", pixelToScreenY);
+    benchVectorEnv("vectorEnv/step_1024", 1024);
+    benchKernel("rollback/snapshot_restore", &freeFlight, snapshotRestore);
+    benchRollback("rollback/8_ticks", 0);
+    benchRollback("rollback/8_ticks_resimulated", 1);
+#ifdef PONG_HAS_ASM_KERNELS
+    benchKernel("kernels/resetBall_asm", &freeFlight, asmResetBall);
+    benchKernel("kernels/updateAI_asm", &aiTracking, asmUpdateAI);
+    benchKernel("kernels/mouse_asm", &freeFlight, asmMouseKernel);
+    benchBatchedAI("kernels/updateAI_asm_1024", 1024, 0);
+#endif
+    benchKernel("kernels/resetBall_portable", &freeFlight, portableResetBallKernel);
+    benchKernel("kernels/updateAI_portable", &aiTracking, portableUpdateAIKernel);
+    benchKernel("kernels/mouse_portable", &freeFlight, portableMouseKernel);
+    benchBatchedAI("kernels/updateAI_portable_1024", 1024, 1);
+    benchChaos("chaos/balls_100", 100, 0);
+    benchChaos("chaos/balls_1000", 1000, 0);
+    benchChaos("chaos/balls_10000", 10000, 0);
+    benchChaos("chaos/balls_1000_every_pair", 1000, 1);
+    benchTelemetry("telemetry/push");
+    benchArena("arena/standard_constant", StandardArena());
+    benchArena("arena/standard_generic", RuntimeArena{findArena("standard")});
+}
+
+//States the frames are drawn from
+Global frameIntro;
+Global frameGame;
+Global frameGameOver;
+
+void initFrameStates(){
+    frameIntro = benchState(900, 500, 1);
+    frameIntro.introScreen = 0;
+    frameGame = benchState(900, 500, 1);
+    frameGame.playerScore = 3;
+    frameGame.aiScore = 5;
+    frameGameOver = frameGame;
+    frameGameOver.aiScore = winningScore;
+    frameGameOver.gameOver = 1;
+}
+
+//Times frameCount frames of drawFrame
+void benchFrame(const char* name, const Global* state, void (*drawFrame)(const Global*)){
+    if (!selected(name)) {
+        return;
+    }
+    std::vector<double> samples;
+    for (int r = 0; r < repetitions; r++) {
+        //Warm up caches and lazily built things (the intro display list, score layer) before timing
+        drawFrame(state);
+        double start = secondsNow();
+        for (int i = 0; i < frameCount; i++) {
+            drawFrame(state);
+        }
+        samples.push_back((secondsNow() - start) * 1e3 / frameCount);
+    }
+    addResult(name, "ms", frameCount, samples);
+}
+
+//The same four frames for a renderer, named frame/<key>/...
+void benchFrames(const char* key, void (*drawFrame)(const Global*)){
+    static char names[8][4][64];
+    static int used = 0;
+    char (*frameNames)[64] = names[used++ % 8];
+    snprintf(frameNames[0], 64, "frame/%s/game", key);
+    snprintf(frameNames[1], 64, "frame/%s/game_over", key);
+    snprintf(frameNames[2], 64, "frame/%s/intro", key);
+    snprintf(frameNames[3], 64, "frame/%s/overlay", key);
+    showOverlay = 0;
+    benchFrame(frameNames[0], &frameGame, drawFrame);
+    benchFrame(frameNames[1], &frameGameOver, drawFrame);
+    benchFrame(frameNames[2], &frameIntro, drawFrame);
+    showOverlay = 1;
+    benchFrame(frameNames[3], &frameGame, drawFrame);
+    showOverlay = 0;
+}
+
+SoftFramebuffer softFrame;
+
+void drawSoftFrame(const Global* state){
+    drawSoftGameView(&softFrame, state, state);
+}
+
+void runSoftFrameBenchmarks(){
+    initSoftFramebuffer(&softFrame, screenWidth, screenHeight);
+    benchFrames("software", drawSoftFrame);
+    destroySoftFramebuffer(&softFrame);
+}
+
+#ifdef PONG_BENCH_EGL
+//Finished with glFinish, so the rendering is counted
+void drawGLFrame(const Global* state){
+    drawGameView(state, state);
+    glFinish();
+}
+
+//Short names for the rect renderer modes, for the benchmark names
+const char* modeKey(int mode){
+    switch (mode) {
+        case RECT_RENDERER_PERSISTENT:
+            return "persistent";
+        case RECT_RENDERER_INSTANCED:
+            return "instanced";
+        default:
+            return "immediate";
+    }
+}
+
+void runFrameBenchmarks(const char** renderer, int hardware){
+    if (createOffscreenContext(screenWidth, screenHeight, hardware) != 0) {
+        fprintf(stderr, "no offscreen OpenGL context, skipping OpenGL frame benchmarks\n");
+        return;
+    }
+    *renderer = (const char*) glGetString(GL_RENDERER);
+
+    //The best mode the context has, then the immediate mode fallback
+    for (int immediate = 0; immediate < 2; immediate++) {
+        int mode = initGameView(immediate);
+        if (!immediate || mode == RECT_RENDERER_IMMEDIATE) {
+            benchFrames(modeKey(mode), drawGLFrame);
+        }
+        destroyGameView();
+    }
+}
+
+//Pixels whose color differs between the OpenGL frame that was just drawn and the software one. Alpha isn't
+//compared, the pbuffer may not have any.
+long countMismatches(const char* name, std::vector<unsigned char>& readback){
+    glReadPixels(0, 0, screenWidth, screenHeight, GL_RGBA, GL_UNSIGNED_BYTE, readback.data());
+    const unsigned char* soft = (const unsigned char*) softFrame.pixels;
+    long mismatches = 0;
+    for (long i = 0; i < (long) screenWidth * screenHeight; i++) {
+        if (memcmp(&readback[i * 4], &soft[i * 4], 3) != 0) {
+            if (mismatches == 0) {
+                fprintf(stderr, "%s: first mismatch at %ld, %ld\n", name, i % screenWidth,
+                        screenHeight - 1 - i / screenWidth);
+            }
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+//Checks that the software renderer draws the same pixels as every OpenGL mode: frames from random game states,
+//and every glyph of the font at the scales the game uses. The intro screen's 3D scene isn't drawn in software,
+//so it's left out. Returns the number of frames that differ.
+int runFrameVerify(int hardware, int frames){
+    if (createOffscreenContext(screenWidth, screenHeight, hardware) != 0) {
+        fprintf(stderr, "no offscreen OpenGL context\n");
+        return 1;
+    }
+    initSoftFramebuffer(&softFrame, screenWidth, screenHeight);
+    std::vector<unsigned char> readback((size_t) screenWidth * screenHeight * 4);
+    char glyphs[glyphCount + 1];
+    for (int i = 0; i < glyphCount; i++) {
+        glyphs[i] = (char) (firstGlyph + i);
+    }
+    glyphs[glyphCount] = 0;
+
+    int failed = 0;
+    int checked = 0;
+    for (int immediate = 0; immediate < 2; immediate++) {
+        int mode = initGameView(immediate);
+        if (immediate && mode != RECT_RENDERER_IMMEDIATE) {
+            destroyGameView();
+            continue;
+        }
+        unsigned int seed = 12345;
+        for (int frame = 0; frame < frames; frame++) {
+            //Anywhere on the screen, partly off it too
+            Global state = benchState(rand_r(&seed) % (screenWidth + 60) - 30, rand_r(&seed) % (screenHeight + 60) - 30, 1);
+            state.playerPaddlePosition.y = rand_r(&seed) % (screenHeight + 100) - 50 - paddleLength / 2;
+            state.aiPaddlePosition.y = rand_r(&seed) % (screenHeight + 100) - 50 - paddleLength / 2;
+            state.playerScore = rand_r(&seed) % (winningScore + 1);
+            state.aiScore = rand_r(&seed) % (winningScore + 1);
+            state.gameOver = rand_r(&seed) % 4 == 0;
+            drawGameView(&state, &state);
+            drawSoftGameView(&softFrame, &state, &state);
+            failed += countMismatches(modeKey(mode), readback) != 0;
+            checked++;
+        }
+
+        for (int scale = 1; scale <= textScale; scale++) {
+            glClear(GL_COLOR_BUFFER_BIT);
+            beginText(&text);
+            clearSoftFramebuffer(&softFrame);
+            for (int line = 0; line < 4; line++) {
+                int y = 100 + line * 200 + scale * 20;
+                Color color = (Color){(unsigned char) (255 - line * 40), 255, (unsigned char) (line * 60)};
+                drawText(&text, glyphs + line * 24, 10 + line, y, scale, color);
+                softDrawText(&softFrame, glyphs + line * 24, 10 + line, y, scale, color);
+            }
+            flushText(&text);
+            failed += countMismatches("font", readback) != 0;
+            checked++;
+        }
+        destroyGameView();
+    }
+    destroySoftFramebuffer(&softFrame);
+    printf("verify: %d frames checked, %d differ\n", checked, failed);
+    return failed;
+}
+#endif
+
+void writeJson(FILE* file, const char* renderer){
+    fprintf(file, "{\n");
+    fprintf(file, "  \"schema\": 1,\n");
+    fprintf(file, "  \"batch_kernel\": \"%s\",\n", batchWorldIsa());
+    fprintf(file, "  \"profiling\": %s,\n", profilingEnabled() ? "true" : "false");
+    fprintf(file, "  \"gl_renderer\": \"%s\",\n", renderer ? renderer : "");
+    fprintf(file, "  \"soft_renderer\": \"%s\",\n", softRendererIsa());
+    fprintf(file, "  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult* result = &results[i];
+        fprintf(file, "    {\"name\": \"%s\", \"unit\": \"%s\", \"iterations\": %ld, \"median\": %.4f, \"min\": %.4f}%s\n",
+                result->name, result->unit, result->iterations, result->median, result->min,
+                i + 1 < results.size() ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+}
+
+void printUsage(const char* program){
+    printf("usage: %s [--output FILE] [--filter TEXT] [--repetitions N] [--quick] [--no-frames] [--hardware]"
+           " [--verify]\n", program);
+    printf("  --output FILE     write the JSON results to FILE instead of stdout\n");
+    printf("  --filter TEXT     only run benchmarks with TEXT in their name\n");
+    printf("  --repetitions N   timed runs per benchmark, the median is reported (default 7)\n");
+    printf("  --quick           fewer iterations, for a smoke test\n");
+    printf("  --no-frames       skip the offscreen frame benchmarks\n");
+    printf("  --hardware        let Mesa use a GPU for the frames instead of forcing software rendering\n");
+    printf("  --verify          compare software and OpenGL frames pixel for pixel instead of benchmarking\n");
+}
+
+int main(int argc, char **argv)
+{
+    const char* outputPath = NULL;
+    int frames = 1;
+    int hardware = 0;
+    int verify = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc) {
+            repetitions = atoi(argv[++i]);
+            repetitions = repetitions > 0 ? repetitions : 1;
+        } else if (strcmp(argv[i], "--quick") == 0) {
+            kernelIterations = 100000;
+            frameCount = 5;
+            repetitions = 3;
+        } else if (strcmp(argv[i], "--no-frames") == 0) {
+            frames = 0;
+        } else if (strcmp(argv[i], "--hardware") == 0) {
+            hardware = 1;
+        } else if (strcmp(argv[i], "--verify") == 0) {
+            verify = 1;
+        } else {
+            printUsage(argv[0]);
+            return strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+
+    if (verify) {
+#ifdef PONG_BENCH_EGL
+        return runFrameVerify(hardware, frameCount) != 0;
+#else
+        fprintf(stderr, "--verify needs a build with EGL\n");
+        return 1;
+#endif
+    }
+
+    runKernelBenchmarks();
+    initFrameStates();
+    const char* renderer = NULL;
+    if (frames) {
+        runSoftFrameBenchmarks();
+#ifdef PONG_BENCH_EGL
+        runFrameBenchmarks(&renderer, hardware);
+#else
+        fprintf(stderr, "built without EGL, skipping OpenGL frame benchmarks\n");
+#endif
+    }
+
+    FILE* output = outputPath ? fopen(outputPath, "w") : stdout;
+    if (!output) {
+        fprintf(stderr, "can't write %s\n", outputPath);
+        return 1;
+    }
+    writeJson(output, renderer);
+    if (output != stdout) {
+        fclose(output);
+    }
+    return 0;
+}
@@ -0,0 +1,134 @@
+// Headless replay capture.
+// Renders a replay into an offscreen OpenGL context, or with the software renderer, and writes it out as video
+// through frame_capture, as fast as the renderer and the writer allow rather than in real time. Frames are blocked
+// on by default, so none are lost.
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "frame_capture.h"
+#include "game_view.h"
+#include "offscreen_context.h"
+#include "replay.h"
+#include "scheduler.h"
+#include "soft_renderer.h"
+
+void printUsage(const char* program){
+    printf("usage: %s --replay FILE --output PATH [--fps N] [--policy drop|block] [--immediate] [--fps-overlay]"
+           " [--hardware] [--software]\n", program);
+    printf("  --output PATH     out.y4m for YUV4MPEG2, frames/%%05d.png for numbered PNGs, anything else for raw RGB24\n");
+    printf("  --fps N           frames per second of video, defaults to the replay's tick rate\n");
+    printf("  --policy P        drop frames or block when the writer falls behind (default block)\n");
+    printf("  --software        draw with the software renderer instead of OpenGL\n");
+}
+
+int main(int argc, char **argv)
+{
+    const char* replayPath = NULL;
+    const char* outputPath = NULL;
+    int fps = 0;
+    int policy = CAPTURE_BLOCK;
+    int immediateMode = 0;
+    int hardware = 0;
+    int software = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            fps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--policy") == 0 && i + 1 < argc) {
+            policy = strcmp(argv[++i], "drop") == 0 ? CAPTURE_DROP : CAPTURE_BLOCK;
+        } else if (strcmp(argv[i], "--immediate") == 0) {
+            immediateMode = 1;
+        } else if (strcmp(argv[i], "--fps-overlay") == 0) {
+            showOverlay = 1;
+        } else if (strcmp(argv[i], "--hardware") == 0) {
+            hardware = 1;
+        } else if (strcmp(argv[i], "--software") == 0) {
+            software = 1;
+        } else {
+            printUsage(argv[0]);
+            return strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+    if (!replayPath || !outputPath) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    ReplayReader reader;
+    if (openReplay(&reader, replayPath) != 0) {
+        printf("can't read replay %s\n", replayPath);
+        return 1;
+    }
+    int tickRate = reader.header->tickRate > 0 ? reader.header->tickRate : defaultTickRate;
+    fps = fps > 0 ? fps : tickRate;
+    overlayTickRate = tickRate;
+
+    SoftFramebuffer framebuffer;
+    if (software) {
+        initSoftFramebuffer(&framebuffer, screenWidth, screenHeight);
+        printf("software renderer (%s)\n", softRendererIsa());
+    } else {
+        if (createOffscreenContext(screenWidth, screenHeight, hardware) != 0) {
+            printf("can't create an offscreen OpenGL context\n");
+            return 1;
+        }
+        int rectMode = initGameView(immediateMode);
+        printf("rect renderer: %s (%s)\n", rectRendererModeName(rectMode), (const char*) glGetString(GL_RENDERER));
+    }
+
+    FrameCapture capture;
+    if (startCapture(&capture, outputPath, screenWidth, screenHeight, fps, policy) != 0) {
+        printf("can't write %s\n", outputPath);
+        return 1;
+    }
+
+    //Frame f shows the game at time f / fps, interpolated between the ticks around it like the window does
+    auto start = std::chrono::steady_clock::now();
+    Global previous = reader.state;
+    long frames = 0;
+    int playing = 1;
+    while (playing) {
+        double time = (double) frames * tickRate / fps;
+        long tick = (long) time;
+        while (reader.tick < tick + 1 && playing) {
+            previous = reader.state;
+            playing = stepReplay(&reader);
+        }
+        if (!playing) {
+            break;
+        }
+        Global view = interpolateGlobal(&previous, &reader.state, (float) (time - tick));
+        if (software) {
+            drawSoftGameView(&framebuffer, &reader.state, &view);
+            captureFramePixels(&capture, framebuffer.pixels);
+        } else {
+            drawGameView(&reader.state, &view);
+            captureFrame(&capture);
+        }
+        frames++;
+    }
+    flushCapture(&capture);
+    int failed = finishCapture(&capture);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("frames: %ld rendered, %ld written, %ld dropped\n", frames, capture.writtenFrames, capture.droppedFrames);
+    printf("time: %.2f s for %.2f s of video (%.1fx real time)\n", seconds, (double) frames / fps,
+           (double) frames / fps / seconds);
+    if (software) {
+        destroySoftFramebuffer(&framebuffer);
+    } else {
+        destroyGameView();
+    }
+    closeReplay(&reader);
+    if (failed) {
+        printf("writing %s failed\n", outputPath);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,411 @@
+// Chaos mode, see chaos.h.
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "chaos.h"
+#include "game_config.h"
+#include "profiler.h"
+
+const int chaosBallArrayCount = 10; //ballX to lastScore, and the grid's arrays with an entry per ball
+
+void initChaosWorld(ChaosWorld* world, int ballCapacity, int obstacleCapacity){
+    memset(world, 0, sizeof(ChaosWorld));
+    size_t arrayBytes = (size_t) ballCapacity * sizeof(int);
+    size_t gridBytes = (size_t) (chaosGridCells + 1) * sizeof(int);
+    world->memory = malloc(arrayBytes * chaosBallArrayCount + gridBytes * 2
+                           + (size_t) obstacleCapacity * sizeof(ChaosObstacle));
+    char* base = (char*) world->memory;
+    int** fields[chaosBallArrayCount] = {
+        &world->ballX, &world->ballY, &world->ballDirectionX, &world->ballDirectionY, &world->ballSpeed,
+        &world->lastScore, &world->ballCell, &world->cellBalls, &world->cellBallX, &world->cellBallY
+    };
+    for (int f = 0; f < chaosBallArrayCount; f++) {
+        *fields[f] = (int*) (base + arrayBytes * f);
+    }
+    base += arrayBytes * chaosBallArrayCount;
+    world->cellStart = (int*) base;
+    world->obstacleCellStart = (int*) (base + gridBytes);
+    world->obstacles = (ChaosObstacle*) (base + gridBytes * 2);
+    world->ballCapacity = ballCapacity;
+    world->obstacleCapacity = obstacleCapacity;
+    world->playerPaddleY = initialPlayerPaddlePosition.y;
+    world->aiPaddleY = initialAiPaddlePosition.y;
+}
+
+void freeChaosWorld(ChaosWorld* world){
+    free(world->cellObstacles);
+    free(world->memory);
+    memset(world, 0, sizeof(ChaosWorld));
+}
+
+int addChaosBall(ChaosWorld* world, Point position, Point direction, int speed){
+    if (world->ballCount == world->ballCapacity) {
+        return -1;
+    }
+    int ball = world->ballCount++;
+    world->ballX[ball] = position.x;
+    world->ballY[ball] = position.y;
+    world->ballDirectionX[ball] = direction.x;
+    world->ballDirectionY[ball] = direction.y;
+    world->ballSpeed[ball] = speed;
+    world->lastScore[ball] = 0;
+    return ball;
+}
+
+int addChaosObstacle(ChaosWorld* world, const ChaosObstacle* obstacle){
+    if (world->obstacleCount == world->obstacleCapacity) {
+        return -1;
+    }
+    world->obstacles[world->obstacleCount] = *obstacle;
+    return world->obstacleCount++;
+}
+
+void removeChaosBall(ChaosWorld* world, int ball){
+    int last = --world->ballCount;
+    world->ballX[ball] = world->ballX[last];
+    world->ballY[ball] = world->ballY[last];
+    world->ballDirectionX[ball] = world->ballDirectionX[last];
+    world->ballDirectionY[ball] = world->ballDirectionY[last];
+    world->ballSpeed[ball] = world->ballSpeed[last];
+    world->lastScore[ball] = world->lastScore[last];
+}
+
+unsigned int chaosRandom(unsigned int* seed){
+    *seed = *seed * 1664525u + 1013904223u;
+    return *seed >> 8;
+}
+
+void fillChaosWorld(ChaosWorld* world, int balls, unsigned int seed){
+    const ChaosObstacle layout[] = {
+        //Blocks in front of each goal, and one in the middle
+        {{screenWidth / 4, goalPosition - 60}, {60, 120}, {0, 0}},
+        {{screenWidth * 3 / 4 - 60, goalPosition - 60}, {60, 120}, {0, 0}},
+        {{screenWidth / 2 - 40, goalPosition - 40}, {80, 80}, {0, 0}},
+        //Bars sliding up and down, and across
+        {{screenWidth / 3, 200}, {30, 240}, {0, 6}},
+        {{screenWidth * 2 / 3, 600}, {30, 240}, {0, -6}},
+        {{800, 150}, {320, 30}, {5, 0}},
+        {{800, screenHeight - 180}, {320, 30}, {-5, 0}},
+    };
+    for (size_t i = 0; i < sizeof(layout) / sizeof(layout[0]); i++) {
+        addChaosObstacle(world, &layout[i]);
+    }
+    const int spawnLeft = paddleOffset + paddleWidth + ballSideLength;
+    const int spawnWidth = screenWidth - 2 * spawnLeft - ballSideLength;
+    const int spawnHeight = screenHeight - 2 * wallThickness - ballSideLength;
+    for (int i = 0; i < balls; i++) {
+        Point position = {spawnLeft + (int) (chaosRandom(&seed) % spawnWidth),
+                          wallThickness + (int) (chaosRandom(&seed) % spawnHeight)};
+        Point direction = {chaosRandom(&seed) % 2 ? 1 : -1, chaosRandom(&seed) % 2 ? 1 : -1};
+        addChaosBall(world, position, direction, 4 + (int) (chaosRandom(&seed) % (initialBallSpeed - 3)));
+    }
+}
+
+void storeChaosBall(const ChaosWorld* world, Global* state){
+    state->playerPaddlePosition = (Point){initialPlayerPaddlePosition.x, world->playerPaddleY};
+    state->aiPaddlePosition = (Point){initialAiPaddlePosition.x, world->aiPaddleY};
+    state->playerScore = world->playerScore;
+    state->aiScore = world->aiScore;
+    state->ballPosition = (Point){world->ballX[0], world->ballY[0]};
+    state->ballSpeed = world->ballSpeed[0];
+    state->ballDirection = (Point){world->ballDirectionX[0], world->ballDirectionY[0]};
+    state->lastScore = world->lastScore[0];
+    state->gameOver = 0;
+    state->introScreen = 1;
+}
+
+void loadChaosBall(ChaosWorld* world, const Global* state){
+    world->playerPaddleY = state->playerPaddlePosition.y;
+    world->aiPaddleY = state->aiPaddlePosition.y;
+    world->playerScore = state->playerScore;
+    world->aiScore = state->aiScore;
+    world->ballX[0] = state->ballPosition.x;
+    world->ballY[0] = state->ballPosition.y;
+    world->ballDirectionX[0] = state->ballDirection.x;
+    world->ballDirectionY[0] = state->ballDirection.y;
+    world->ballSpeed[0] = state->ballSpeed;
+    world->lastScore[0] = state->lastScore;
+}
+
+//Grid column or row of a coordinate, clamped to the grid so balls and obstacles off the screen still land in it
+inline int chaosColumn(int x){
+    int column = x < 0 ? 0 : x / chaosCellSize;
+    return column < chaosGridColumns ? column : chaosGridColumns - 1;
+}
+
+inline int chaosRow(int y){
+    int row = y < 0 ? 0 : y / chaosCellSize;
+    return row < chaosGridRows ? row : chaosGridRows - 1;
+}
+
+//Files every ball under the cell of its top left corner, with a counting sort
+void buildBallGrid(ChaosWorld* world){
+    int* start = world->cellStart;
+    memset(start, 0, sizeof(int) * (chaosGridCells + 1));
+    for (int i = 0; i < world->ballCount; i++) {
+        int cell = chaosRow(world->ballY[i]) * chaosGridColumns + chaosColumn(world->ballX[i]);
+        world->ballCell[i] = cell;
+        start[cell + 1]++;
+    }
+    for (int c = 0; c < chaosGridCells; c++) {
+        start[c + 1] += start[c];
+    }
+    //Fill each cell from its end, moving the start back, so start ends up as the first ball of each cell
+    for (int i = world->ballCount - 1; i >= 0; i--) {
+        world->cellBalls[--start[world->ballCell[i] + 1]] = i;
+    }
+    for (int c = 0; c < chaosGridCells; c++) {
+        start[c] = start[c + 1];
+    }
+    start[chaosGridCells] = world->ballCount;
+    for (int k = 0; k < world->ballCount; k++) {
+        world->cellBallX[k] = world->ballX[world->cellBalls[k]];
+        world->cellBallY[k] = world->ballY[world->cellBalls[k]];
+    }
+}
+
+//Calls visit(cell) for every cell where the corner of a ball touching obstacle can be
+template <class Visit>
+void forObstacleCells(const ChaosObstacle* obstacle, Visit visit){
+    int column1 = chaosColumn(obstacle->position.x - ballSideLength);
+    int column2 = chaosColumn(obstacle->position.x + obstacle->size.x);
+    int row1 = chaosRow(obstacle->position.y - ballSideLength);
+    int row2 = chaosRow(obstacle->position.y + obstacle->size.y);
+    for (int row = row1; row <= row2; row++) {
+        for (int column = column1; column <= column2; column++) {
+            visit(row * chaosGridColumns + column);
+        }
+    }
+}
+
+//Files every obstacle under each cell forObstacleCells gives, with a counting sort
+void buildObstacleGrid(ChaosWorld* world){
+    int* start = world->obstacleCellStart;
+    memset(start, 0, sizeof(int) * (chaosGridCells + 1));
+    for (int o = 0; o < world->obstacleCount; o++) {
+        forObstacleCells(&world->obstacles[o], [&](int cell){ start[cell + 1]++; });
+    }
+    for (int c = 0; c < chaosGridCells; c++) {
+        start[c + 1] += start[c];
+    }
+    int total = start[chaosGridCells];
+    if (total > world->cellObstacleCapacity) {
+        free(world->cellObstacles);
+        world->cellObstacles = (int*) malloc(sizeof(int) * total);
+        world->cellObstacleCapacity = total;
+    }
+    for (int o = world->obstacleCount - 1; o >= 0; o--) {
+        forObstacleCells(&world->obstacles[o], [&](int cell){ world->cellObstacles[--start[cell + 1]] = o; });
+    }
+    for (int c = 0; c < chaosGridCells; c++) {
+        start[c] = start[c + 1];
+    }
+    start[chaosGridCells] = total;
+}
+
+//Which directions a ball flips after touching other boxes
+typedef struct ChaosContact{
+    bool flipX;
+    bool flipY;
+} ChaosContact;
+
+//A ball at (x, y) moving (directionX, directionY) touching the box at (x2, y2) of size (width, height): flips on
+//the axis it went in the least (both on a tie), if it's moving toward the box on that axis. Centers are
+//compared doubled to stay in whole pixels.
+inline void chaosTouch(ChaosContact* contact, int x, int y, int directionX, int directionY, int x2, int y2,
+                       int width, int height){
+    int depthX = (x < x2 ? x + ballSideLength - x2 : x2 + width - x);
+    int depthY = (y < y2 ? y + ballSideLength - y2 : y2 + height - y);
+    int towardX = directionX * ((2 * x2 + width) - (2 * x + ballSideLength)) > 0;
+    int towardY = directionY * ((2 * y2 + height) - (2 * y + ballSideLength)) > 0;
+    if (depthX <= depthY && towardX) {
+        contact->flipX = true;
+    }
+    if (depthY <= depthX && towardY) {
+        contact->flipY = true;
+    }
+}
+
+//Tests ball i against the balls in [first, last) of xs and ys. This is chaosTouch() for two balls, written
+//without branches so the compiler can vectorize it; i itself is among them, but at no distance from itself it
+//is never moving toward itself.
+inline void touchBalls(const ChaosWorld* world, int i, const int* xs, const int* ys, int first, int last,
+                       ChaosContact* contact, long* tests){
+    const int x = world->ballX[i];
+    const int y = world->ballY[i];
+    const int directionX = world->ballDirectionX[i];
+    const int directionY = world->ballDirectionY[i];
+    int flipX = 0;
+    int flipY = 0;
+    for (int k = first; k < last; k++) {
+        int dx = xs[k] - x;
+        int dy = ys[k] - y;
+        int touching = (dx >= -ballSideLength) & (dx <= ballSideLength) & (dy >= -ballSideLength) & (dy <= ballSideLength);
+        int depthX = ballSideLength - (dx < 0 ? -dx : dx);
+        int depthY = ballSideLength - (dy < 0 ? -dy : dy);
+        flipX |= touching & (depthX <= depthY) & (directionX * dx > 0);
+        flipY |= touching & (depthY <= depthX) & (directionY * dy > 0);
+    }
+    contact->flipX = contact->flipX || flipX;
+    contact->flipY = contact->flipY || flipY;
+    *tests += last - first;
+}
+
+//Tests ball i against the obstacles in [first, last) of order (every obstacle when order is NULL)
+inline void touchObstacles(const ChaosWorld* world, int i, const int* order, int first, int last,
+                           ChaosContact* contact, long* tests){
+    int x = world->ballX[i];
+    int y = world->ballY[i];
+    for (int k = first; k < last; k++) {
+        const ChaosObstacle* obstacle = &world->obstacles[order ? order[k] : k];
+        //updateBall()'s test both ways round, so obstacles narrower than a ball count too
+        int ox1 = obstacle->position.x;
+        int oy1 = obstacle->position.y;
+        int ox2 = ox1 + obstacle->size.x;
+        int oy2 = oy1 + obstacle->size.y;
+        if ((arenaOverlap(x, x + ballSideLength, ox1, ox2) || arenaOverlap(ox1, ox2, x, x + ballSideLength))
+            && (arenaOverlap(y, y + ballSideLength, oy1, oy2) || arenaOverlap(oy1, oy2, y, y + ballSideLength))) {
+            chaosTouch(contact, x, y, world->ballDirectionX[i], world->ballDirectionY[i], obstacle->position.x,
+                       obstacle->position.y, obstacle->size.x, obstacle->size.y);
+        }
+    }
+    *tests += last - first;
+}
+
+//updateAI() toward the ball closest to the AI
+void updateChaosAI(ChaosWorld* world){
+    if (world->ballCount == 0) {
+        return;
+    }
+    int closest = 0;
+    for (int i = 1; i < world->ballCount; i++) {
+        if (world->ballX[i] < world->ballX[closest]) {
+            closest = i;
+        }
+    }
+    if (world->ballX[closest] + ballSideLength >= (screenWidth >> 1)) {
+        return;
+    }
+    int distance = world->ballY[closest] + (ballSideLength >> 1) - (paddleLength >> 1) - world->aiPaddleY;
+    if (distance > initialBallSpeed) {
+        world->aiPaddleY += aiPaddleSpeed;
+    } else if (distance < -initialBallSpeed) {
+        world->aiPaddleY -= aiPaddleSpeed;
+    }
+}
+
+//Slides the moving obstacles, bouncing them off the walls
+void moveChaosObstacles(ChaosWorld* world){
+    for (int o = 0; o < world->obstacleCount; o++) {
+        ChaosObstacle* obstacle = &world->obstacles[o];
+        obstacle->position.x += obstacle->velocity.x;
+        obstacle->position.y += obstacle->velocity.y;
+        int maxX = screenWidth - wallThickness - obstacle->size.x;
+        int maxY = screenHeight - wallThickness - obstacle->size.y;
+        if (obstacle->position.x < wallThickness || obstacle->position.x > maxX) {
+            obstacle->velocity.x = -obstacle->velocity.x;
+            obstacle->position.x = obstacle->position.x < wallThickness ? wallThickness : maxX;
+        }
+        if (obstacle->position.y < wallThickness || obstacle->position.y > maxY) {
+            obstacle->velocity.y = -obstacle->velocity.y;
+            obstacle->position.y = obstacle->position.y < wallThickness ? wallThickness : maxY;
+        }
+    }
+}
+
+int stepChaosWorld(ChaosWorld* world, int mouseY){
+    PROFILE_SCOPE("stepChaosWorld");
+    world->playerPaddleY = mouseY - (paddleLength >> 1);
+    if (!world->bruteForce) {
+        buildBallGrid(world);
+        buildObstacleGrid(world);
+    }
+
+    //Contacts first, all from where everything is at the start of the tick. Only the directions change here,
+    //and only those of the ball being tested are read.
+    const GameConfig config = StandardArena::get();
+    const Point player = {initialPlayerPaddlePosition.x, world->playerPaddleY};
+    const Point ai = {initialAiPaddlePosition.x, world->aiPaddleY};
+    long tests = 0;
+    int goals = 0;
+    for (int i = 0; i < world->ballCount; i++) {
+        int x1 = world->ballX[i];
+        int y1 = world->ballY[i];
+
+        //updateBall()'s paddle test
+        bool paddleHit = arenaPaddleHit(x1, y1, player, config) || arenaPaddleHit(x1, y1, ai, config);
+
+        ChaosContact contact = {false, false};
+        if (world->bruteForce) {
+            touchBalls(world, i, world->ballX, world->ballY, 0, world->ballCount, &contact, &tests);
+            touchObstacles(world, i, NULL, 0, world->obstacleCount, &contact, &tests);
+        } else {
+            int cell = world->ballCell[i];
+            int column = cell % chaosGridColumns;
+            int row = cell / chaosGridColumns;
+            for (int r = row > 0 ? row - 1 : 0; r <= row + 1 && r < chaosGridRows; r++) {
+                //The cells of a row of the 3x3 block are next to each other in cellBalls
+                int first = r * chaosGridColumns + (column > 0 ? column - 1 : 0);
+                int last = r * chaosGridColumns + (column + 1 < chaosGridColumns ? column + 1 : column);
+                touchBalls(world, i, world->cellBallX, world->cellBallY, world->cellStart[first],
+                           world->cellStart[last + 1], &contact, &tests);
+            }
+            touchObstacles(world, i, world->cellObstacles, world->obstacleCellStart[cell],
+                           world->obstacleCellStart[cell + 1], &contact, &tests);
+        }
+
+        int directionX = world->ballDirectionX[i];
+        int directionY = world->ballDirectionY[i];
+        if (paddleHit) {
+            directionX = -directionX;
+        }
+        if (contact.flipX) {
+            directionX = -directionX;
+        }
+        if (contact.flipY) {
+            directionY = -directionY;
+        }
+        //updateBall()'s walls
+        ArenaWalls walls = arenaWalls(x1, y1, config);
+        if (walls.ceiling || walls.floor) {
+            directionY = -directionY;
+        }
+        if (walls.left || walls.right) {
+            directionX = -directionX;
+        }
+        world->ballDirectionX[i] = directionX;
+        world->ballDirectionY[i] = directionY;
+    }
+
+    //Then every ball moves, or scores, as the rest of updateBall() does it
+    for (int i = 0; i < world->ballCount; i++) {
+        int x1 = world->ballX[i];
+        int y1 = world->ballY[i];
+        ArenaWalls walls = arenaWalls(x1, y1, config);
+        bool pastLeft = walls.left;
+        if (arenaInGoal(y1, config) && (walls.left || walls.right)) {
+            //resetBall(), served away from whoever scored, from a place on the middle line that depends on the ball
+            int spread = (int) (((long) i * 97) % 801);
+            world->playerScore += pastLeft;
+            world->aiScore += !pastLeft;
+            world->lastScore[i] = pastLeft;
+            world->ballX[i] = initialBallPosition.x;
+            world->ballY[i] = initialBallPosition.y + (spread <= 400 ? spread : 400 - spread);
+            world->ballDirectionX[i] = pastLeft ? initialBallDirection.x : -initialBallDirection.x;
+            world->ballDirectionY[i] = initialBallDirection.y;
+            world->ballSpeed[i] = initialBallSpeed;
+            goals++;
+            continue;
+        }
+        int y = arenaClampY(y1, walls, config);
+        world->ballX[i] = x1 + world->ballDirectionX[i] * world->ballSpeed[i];
+        world->ballY[i] = y + world->ballDirectionY[i] * world->ballSpeed[i];
+    }
+    world->pairTests = tests;
+    updateChaosAI(world);
+    moveChaosObstacles(world);
+    world->ticks++;
+    return goals;
+}
@@ -0,0 +1,94 @@
+// Chaos mode: many balls and obstacles in one arena.
+// The balls are stored struct-of-arrays like BatchWorld's lanes, but they share one arena: the two paddles,
+// the walls and goals of simulation.h, and a set of box obstacles that are either static or slide back and
+// forth between the walls. Balls bounce off each other too.
+//
+// Every tick a uniform grid over the screen is rebuilt with a counting sort: each ball is filed under the
+// cell of its top left corner, and each obstacle under every cell a ball touching it could have its corner
+// in. The cells are a little bigger than a ball, so a ball only tests the balls of the 3x3 cells around its
+// own and the obstacles of its own cell, instead of every other ball and obstacle.
+//
+// The rules are those of updateBall() and updateAI(), through the same paddle, wall and goal tests as the step
+// functions of game_config.h: contact is tested where everything is at the start of
+// the tick, touching a paddle flips the ball's x direction, the walls flip and clamp it, and a ball in a goal
+// scores and is served again from the middle line. Ball 0 is served from the middle itself, the others spread
+// out along the line so they don't all pile up in one place. Balls and obstacles have sides, so a ball
+// touching one flips its direction on the axis it went in the least, if it's moving toward the other box on
+// that axis. Each ball only changes its own direction, so the result doesn't depend on the order the balls
+// are tested in, and one ball with no obstacles moves exactly like the ball of mouse() followed by gameLogic().
+
+#ifndef PONG_CHAOS_H
+#define PONG_CHAOS_H
+
+#include "simulation.h"
+
+const int chaosCellSize = 32; //Pixels, more than ballSideLength
+const int chaosGridColumns = (screenWidth + chaosCellSize - 1) / chaosCellSize;
+const int chaosGridRows = (screenHeight + chaosCellSize - 1) / chaosCellSize;
+const int chaosGridCells = chaosGridColumns * chaosGridRows;
+
+typedef struct ChaosObstacle{
+    Point position; //Top left corner
+    Point size;
+    Point velocity; //Pixels/Tick, (0, 0) for a static obstacle
+} ChaosObstacle;
+
+typedef struct ChaosWorld{
+    int ballCount;
+    int ballCapacity;
+    //One entry per ball
+    int* ballX;
+    int* ballY;
+    int* ballDirectionX;
+    int* ballDirectionY;
+    int* ballSpeed;
+    int* lastScore;
+    int obstacleCount;
+    int obstacleCapacity;
+    ChaosObstacle* obstacles;
+    int playerPaddleY;
+    int aiPaddleY;
+    int playerScore;
+    int aiScore;
+    long ticks;
+    int bruteForce; //Test every pair instead of using the grid, to check the grid against
+    long pairTests; //Ball-ball and ball-obstacle tests in the last step
+    //Broadphase, rebuilt every step. The balls of cell c are cellBalls[cellStart[c]] to
+    //cellBalls[cellStart[c + 1] - 1], the same for the obstacles. cellBallX and cellBallY hold the positions
+    //of the balls in the same order, so the balls of a row of cells are read one after the other.
+    int* ballCell;
+    int* cellStart;
+    int* cellBalls;
+    int* cellBallX;
+    int* cellBallY;
+    int* obstacleCellStart;
+    int* cellObstacles;
+    int cellObstacleCapacity;
+    void* memory; //Backing allocation for the ball arrays and the grid, except cellObstacles
+} ChaosWorld;
+
+//Allocates an empty world with room for ballCapacity balls and obstacleCapacity obstacles, with the paddles
+//where initGlobals() puts them
+void initChaosWorld(ChaosWorld* world, int ballCapacity, int obstacleCapacity);
+void freeChaosWorld(ChaosWorld* world);
+
+//Add a ball (top left corner, direction -1 or 1 on each axis) or an obstacle. Return its index, -1 if full.
+int addChaosBall(ChaosWorld* world, Point position, Point direction, int speed);
+int addChaosObstacle(ChaosWorld* world, const ChaosObstacle* obstacle);
+
+//Removes a ball; the last ball takes its index
+void removeChaosBall(ChaosWorld* world, int ball);
+
+//Fills an empty world with the standard chaos layout: a few static blocks, a few sliding bars, and balls
+//balls at pseudo random places, directions and speeds from seed
+void fillChaosWorld(ChaosWorld* world, int balls, unsigned int seed);
+
+//Copies the arena and ball 0 to or from a Global, e.g. to compare one ball against gameLogic()
+void storeChaosBall(const ChaosWorld* world, Global* state);
+void loadChaosBall(ChaosWorld* world, const Global* state);
+
+//Advances the world one tick with the player's mouse at mouseY. The AI follows the ball closest to it.
+//Returns the goals scored in the tick.
+int stepChaosWorld(ChaosWorld* world, int mouseY);
+
+#endif //PONG_CHAOS_H
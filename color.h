@@ -0,0 +1,16 @@
+// Color type shared by the renderers.
+
+#ifndef PONG_COLOR_H
+#define PONG_COLOR_H
+
+//Color struct
+//OpenGl can use either float or unsigned char for color values.
+//This struct uses unsigned char, which is what GLubyte is.
+//Make sure that you are calling the correct color function in OpenGL, when using this struct.
+typedef struct Color{
+    unsigned char r; //0-255
+    unsigned char g; //0-255
+    unsigned char b; //0-255
+} Color;
+
+#endif //PONG_COLOR_H
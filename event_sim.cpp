@@ -0,0 +1,106 @@
+// Event driven stepping, see event_sim.h.
+// The conditions below mirror the tests in updateBall() and updateAI() exactly, including their inclusive ends.
+
+#include "event_sim.h"
+
+const long eventNever = 1L << 40;
+
+//First t >= 0 at which start + velocity * t lies in [low, high], or eventNever
+long firstTickInside(long start, long velocity, long low, long high){
+    if (start >= low && start <= high) {
+        return 0;
+    }
+    if (velocity > 0 && start < low) {
+        long t = (low - start + velocity - 1) / velocity;
+        return start + velocity * t <= high ? t : eventNever;
+    }
+    if (velocity < 0 && start > high) {
+        long t = (start - high - velocity - 1) / -velocity;
+        return start + velocity * t >= low ? t : eventNever;
+    }
+    return eventNever;
+}
+
+long minTicks(long a, long b){
+    return a < b ? a : b;
+}
+
+//Whether updateAI() moves the paddle once the ball is at ballX
+int aiTracking(long ballX){
+    return ballX + ballSideLength < screenWidth / 2;
+}
+
+//How far the ball center is below the AI paddle center, as updateAI() computes it
+long aiDistance(long ballY, long aiY){
+    return ballY + (ballSideLength / 2) - (paddleLength / 2) - aiY;
+}
+
+//Velocity updateAI() gives the paddle for a distance
+int aiVelocity(long distance){
+    if (distance > initialBallSpeed) {
+        return aiPaddleSpeed;
+    }
+    if (distance < -initialBallSpeed) {
+        return -aiPaddleSpeed;
+    }
+    return 0;
+}
+
+long quietTicks(const Global* state, long limit){
+    const long far = 1L << 30;
+    long x = state->ballPosition.x;
+    long y = state->ballPosition.y;
+    long vx = (long) state->ballDirection.x * state->ballSpeed;
+    long vy = (long) state->ballDirection.y * state->ballSpeed;
+
+    //updateBall() does more than move the ball when, before the move, the ball is past a wall or overlaps the
+    //column of a paddle. Whether it overlaps the paddle itself doesn't matter, the column is enough to stop.
+    long ticks = limit;
+    ticks = minTicks(ticks, firstTickInside(x, vx, -far, wallThickness));
+    ticks = minTicks(ticks, firstTickInside(x, vx, screenWidth - wallThickness, far));
+    ticks = minTicks(ticks, firstTickInside(y, vy, -far, wallThickness));
+    ticks = minTicks(ticks, firstTickInside(y, vy, screenHeight - wallThickness, far));
+    ticks = minTicks(ticks, firstTickInside(x, vx, state->aiPaddlePosition.x - ballSideLength,
+                                           state->aiPaddlePosition.x + paddleWidth));
+    ticks = minTicks(ticks, firstTickInside(x, vx, state->playerPaddlePosition.x - ballSideLength,
+                                           state->playerPaddlePosition.x + paddleWidth));
+    if (ticks <= 0) {
+        return 0;
+    }
+
+    //updateAI() runs after the move, so tick j sees the ball at start + velocity * (j + 1)
+    const long trackingEnd = screenWidth / 2 - ballSideLength - 1; //Last ball x the AI tracks at
+    if (aiTracking(x + vx)) {
+        ticks = minTicks(ticks, firstTickInside(x + vx, vx, trackingEnd + 1, far));
+
+        //The distance changes by the same amount every tick while the AI keeps its velocity
+        long distance = aiDistance(y + vy, state->aiPaddlePosition.y);
+        int velocity = aiVelocity(distance);
+        long rate = vy - velocity;
+        if (velocity > 0) {
+            ticks = minTicks(ticks, firstTickInside(distance, rate, -far, initialBallSpeed));
+        } else if (velocity < 0) {
+            ticks = minTicks(ticks, firstTickInside(distance, rate, -initialBallSpeed, far));
+        } else {
+            ticks = minTicks(ticks, firstTickInside(distance, rate, -far, -initialBallSpeed - 1));
+            ticks = minTicks(ticks, firstTickInside(distance, rate, initialBallSpeed + 1, far));
+        }
+    } else {
+        ticks = minTicks(ticks, firstTickInside(x + vx, vx, -far, trackingEnd));
+    }
+    return ticks;
+}
+
+void advanceQuietTicks(Global* state, long ticks){
+    if (ticks <= 0) {
+        return;
+    }
+    int vx = state->ballDirection.x * state->ballSpeed;
+    int vy = state->ballDirection.y * state->ballSpeed;
+    if (aiTracking(state->ballPosition.x + vx)) {
+        int velocity = aiVelocity(aiDistance(state->ballPosition.y + vy, state->aiPaddlePosition.y));
+        state->aiPaddlePosition.y += velocity * (int) ticks;
+    }
+    state->ballPosition.x += vx * (int) ticks;
+    state->ballPosition.y += vy * (int) ticks;
+}
@@ -0,0 +1,23 @@
+// Event driven stepping for the tick based simulation.
+// Between bounces the ball moves in a straight line, and the AI either stands still or moves at aiPaddleSpeed,
+// so most ticks of gameLogic() are predictable. quietTicks() works out in closed form how many ticks will pass
+// before anything but that happens: the ball reaching a wall or the column of a paddle, the AI starting or
+// stopping tracking as the ball crosses midfield, or the AI starting or stopping moving. Those ticks are then
+// applied in one go, and only the ticks around events are run through gameLogic().
+//
+// The result is exactly the state the tick loop would reach. The player paddle can't change anything while the
+// ball is away from its column, so the caller only needs to apply the mouse of the last skipped tick.
+
+#ifndef PONG_EVENT_SIM_H
+#define PONG_EVENT_SIM_H
+
+#include "simulation.h"
+
+//Number of ticks from now, at most limit, in which gameLogic() would only move the ball in a straight line and
+//the AI paddle at a constant velocity. 0 means the next tick has an event and has to go through gameLogic().
+long quietTicks(const Global* state, long limit);
+
+//Applies ticks quiet ticks to state, which must not be more than quietTicks() returned
+void advanceQuietTicks(Global* state, long ticks);
+
+#endif //PONG_EVENT_SIM_H
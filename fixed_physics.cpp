@@ -0,0 +1,147 @@
+// Fixed point ball physics, see fixed_physics.h.
+
+#include "fixed_physics.h"
+#include "profiler.h"
+
+//Largest r with r * r <= value, one bit at a time
+uint64_t integerSqrt(uint64_t value){
+    uint64_t root = 0;
+    uint64_t bit = (uint64_t) 1 << 62;
+    while (bit > value) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+fixed fixedLength(fixed x, fixed y){
+    //The sum of squares has 32 fraction bits, so its square root has 16
+    uint64_t squares = (uint64_t) ((int64_t) x * x) + (uint64_t) ((int64_t) y * y);
+    return (fixed) integerSqrt(squares);
+}
+
+void resetFixedBall(FixedBall* ball, int lastScore){
+    ball->x = toFixed(initialBallPosition.x);
+    ball->y = toFixed(initialBallPosition.y);
+    ball->vx = toFixed((lastScore == 0 ? -initialBallDirection.x : initialBallDirection.x) * initialBallSpeed);
+    ball->vy = toFixed(initialBallDirection.y * initialBallSpeed);
+    ball->speed = fixedLength(ball->vx, ball->vy);
+}
+
+//Sends the ball back from a paddle at paddleY, toward direction (-1 or 1). The further from the paddle's middle
+//it hit, the steeper it leaves.
+void bounceOffPaddle(FixedBall* ball, int paddleY, int direction){
+    fixed reach = toFixed(paddleLength + ballSideLength) / 2;
+    fixed offset = ball->y + toFixed(ballSideLength) / 2 - (toFixed(paddleY) + toFixed(paddleLength) / 2);
+    fixed slope = fixedMul(fixedDiv(offset, reach), maxBounceSlope);
+    slope = slope > maxBounceSlope ? maxBounceSlope : slope < -maxBounceSlope ? -maxBounceSlope : slope;
+
+    fixed speed = fixedMul(ball->speed, ballSpeedup);
+    ball->speed = speed < maxFixedBallSpeed ? speed : maxFixedBallSpeed;
+    fixed length = fixedLength(fixedOne, slope);
+    ball->vx = direction * fixedDiv(ball->speed, length);
+    ball->vy = fixedDiv(fixedMul(ball->speed, slope), length);
+}
+
+//Boxes touch, edges inclusive like the tests in updateBall()
+int overlaps(fixed a1, fixed a2, fixed b1, fixed b2){
+    return a1 <= b2 && b1 <= a2;
+}
+
+int stepFixedBall(FixedBall* ball, int playerPaddleY, int aiPaddleY){
+    fixed side = toFixed(ballSideLength);
+    fixed x2 = ball->x + side;
+    fixed y2 = ball->y + side;
+
+    //Paddles, only while the ball is heading toward them so it can't be caught inside one
+    fixed playerX = toFixed(initialPlayerPaddlePosition.x);
+    if (ball->vx > 0 && overlaps(ball->x, x2, playerX, playerX + toFixed(paddleWidth))
+        && overlaps(ball->y, y2, toFixed(playerPaddleY), toFixed(playerPaddleY + paddleLength))) {
+        bounceOffPaddle(ball, playerPaddleY, -1);
+    }
+    fixed aiX = toFixed(initialAiPaddlePosition.x);
+    if (ball->vx < 0 && overlaps(ball->x, x2, aiX, aiX + toFixed(paddleWidth))
+        && overlaps(ball->y, y2, toFixed(aiPaddleY), toFixed(aiPaddleY + paddleLength))) {
+        bounceOffPaddle(ball, aiPaddleY, 1);
+    }
+
+    //Ceiling and floor
+    if (ball->y <= toFixed(wallThickness)) {
+        ball->y = toFixed(wallThickness);
+        ball->vy = ball->vy < 0 ? -ball->vy : ball->vy;
+    }
+    if (y2 >= toFixed(screenHeight - wallThickness)) {
+        ball->y = toFixed(screenHeight - wallThickness) - side;
+        ball->vy = ball->vy > 0 ? -ball->vy : ball->vy;
+    }
+
+    //Side walls, with the goals in them
+    int inGoal = ball->y >= toFixed(goalPosition - goalHeight / 2) && ball->y + side <= toFixed(goalPosition + goalHeight / 2);
+    if (ball->x <= toFixed(wallThickness)) {
+        if (inGoal) {
+            return FIXED_BALL_PLAYER_GOAL;
+        }
+        ball->x = toFixed(wallThickness);
+        ball->vx = ball->vx < 0 ? -ball->vx : ball->vx;
+    }
+    if (x2 >= toFixed(screenWidth - wallThickness)) {
+        if (inGoal) {
+            return FIXED_BALL_AI_GOAL;
+        }
+        ball->x = toFixed(screenWidth - wallThickness) - side;
+        ball->vx = ball->vx > 0 ? -ball->vx : ball->vx;
+    }
+
+    ball->x += ball->vx;
+    ball->y += ball->vy;
+    return FIXED_BALL_MOVED;
+}
+
+void fixedBallFromGlobal(FixedBall* ball, const Global* state){
+    ball->x = toFixed(state->ballPosition.x);
+    ball->y = toFixed(state->ballPosition.y);
+    ball->vx = toFixed(state->ballDirection.x * state->ballSpeed);
+    ball->vy = toFixed(state->ballDirection.y * state->ballSpeed);
+    ball->speed = fixedLength(ball->vx, ball->vy);
+}
+
+void fixedBallToGlobal(const FixedBall* ball, Global* state){
+    state->ballPosition = (Point){fixedToPixel(ball->x), fixedToPixel(ball->y)};
+    state->ballDirection = (Point){(ball->vx > 0) - (ball->vx < 0), (ball->vy > 0) - (ball->vy < 0)};
+    state->ballSpeed = fixedToPixel(ball->speed + fixedOne / 2);
+}
+
+void gameLogicFixed(FixedBall* ball){
+    PROFILE_SCOPE("gameLogicFixed");
+    if (global.introScreen == 0) {
+        return;
+    }
+
+    if (global.gameOver == 0) {
+        int event = stepFixedBall(ball, global.playerPaddlePosition.y, global.aiPaddlePosition.y);
+        //Scored like updateBall() does it
+        if (event == FIXED_BALL_PLAYER_GOAL) {
+            global.playerScore += 1;
+            global.lastScore = 1;
+            resetFixedBall(ball, global.lastScore);
+        } else if (event == FIXED_BALL_AI_GOAL) {
+            global.aiScore += 1;
+            global.lastScore = 0;
+            resetFixedBall(ball, global.lastScore);
+        }
+        fixedBallToGlobal(ball, &global);
+        updateAI();
+    }
+
+    if (global.playerScore >= winningScore || global.aiScore >= winningScore) {
+        global.gameOver = 1;
+    }
+}
@@ -0,0 +1,84 @@
+// Fixed point ball physics.
+// The ball of Global moves in whole pixels along the diagonals only: its direction is -1 or 1 on each axis. The
+// ball here keeps its position and velocity in Q16.16 fixed point instead (16 integer bits, 16 fraction bits), so
+// it moves by fractions of a pixel, at any angle, and can speed up by fractional factors. Where the ball meets a
+// paddle sets the angle it leaves at: straight back from the middle, up to maxBounceSlope from the ends.
+//
+// Only integer adds, compares, 64 bit multiplies and divides, arithmetic right shifts and an integer square root
+// are used, so every build computes the same bits; there is no floating point anywhere. A FixedBall is five
+// int32s and stepping one is the same arithmetic for every ball, so an array of them (or one array per field)
+// steps in lanes the way BatchWorld does.
+// The rest of the game (paddles, scores, the AI, drawing) keeps using Global, and fixedBallToGlobal puts the
+// ball in it, rounded down to pixels.
+
+#ifndef PONG_FIXED_PHYSICS_H
+#define PONG_FIXED_PHYSICS_H
+
+#include <stdint.h>
+
+#include "simulation.h"
+
+typedef int32_t fixed; //Q16.16
+
+const int fixedShift = 16;
+const fixed fixedOne = 1 << fixedShift;
+
+const fixed maxBounceSlope = 3 * fixedOne / 2; //vy/vx leaving a paddle's end, about 56 degrees
+const fixed ballSpeedup = fixedOne + fixedOne / 20; //Speed factor per paddle hit, 1.05
+const fixed maxFixedBallSpeed = 60 * fixedOne; //Pixels/Tick, under paddleWidth + ballSideLength so no paddle is skipped
+
+typedef struct FixedBall{
+    fixed x; //Top left corner, pixels
+    fixed y;
+    fixed vx; //Pixels/Tick
+    fixed vy;
+    fixed speed; //Length of (vx, vy)
+} FixedBall;
+
+//What a step of the ball did
+enum FixedBallEvent{
+    FIXED_BALL_MOVED = 0,
+    FIXED_BALL_PLAYER_GOAL = 1, //Went into the left goal, a point for the player
+    FIXED_BALL_AI_GOAL = 2 //Went into the right goal, a point for the AI
+};
+
+inline fixed toFixed(int pixels){
+    return pixels * fixedOne;
+}
+
+//Rounds down, also for negative values: the shift is arithmetic with every compiler we build with
+inline int fixedToPixel(fixed value){
+    return value >> fixedShift;
+}
+
+inline fixed fixedMul(fixed a, fixed b){
+    return (fixed) (((int64_t) a * b) >> fixedShift);
+}
+
+//Rounds toward zero
+inline fixed fixedDiv(fixed a, fixed b){
+    return (fixed) (((int64_t) a * fixedOne) / b);
+}
+
+//Length of (x, y), rounded down
+fixed fixedLength(fixed x, fixed y);
+
+//Puts the ball in the middle, served away from whoever scored last (see resetBall()), at the speed and angle of
+//the integer ball
+void resetFixedBall(FixedBall* ball, int lastScore);
+
+//Moves the ball one tick with the paddles at these heights (top edges, pixels), like updateBall(): collisions
+//are tested where the ball is, then it moves. Returns a FixedBallEvent; after a goal the ball is left where it
+//was, for the caller to score and reset.
+int stepFixedBall(FixedBall* ball, int playerPaddleY, int aiPaddleY);
+
+//Takes the ball of state, e.g. after initGlobals() or resetGame()
+void fixedBallFromGlobal(FixedBall* ball, const Global* state);
+
+//Copies the ball to state in pixels: position rounded down, direction as the signs of the velocity
+void fixedBallToGlobal(const FixedBall* ball, Global* state);
+
+//gameLogic() with the ball moved by stepFixedBall, on global
+void gameLogicFixed(FixedBall* ball);
+
+#endif //PONG_FIXED_PHYSICS_H
@@ -0,0 +1,23 @@
+// Bitmap font shared by every text renderer.
+// Printable ASCII (32-126) in 5x9 pixel glyphs: 7 rows above the baseline and 2 for descenders.
+// Glyphs are scaled by whole numbers only, so they stay pixel exact at any size.
+
+#ifndef PONG_FONT_DATA_H
+#define PONG_FONT_DATA_H
+
+const int glyphWidth = 5; //Pixels
+const int glyphHeight = 9;
+const int glyphAdvance = 6; //Glyph width plus one pixel of spacing
+const int glyphBaseline = 7; //Rows above the baseline
+const int firstGlyph = 32; //' '
+const int glyphCount = 95;
+
+extern const unsigned char fontGlyphs[glyphCount][glyphHeight];
+
+//1 if the pixel at column, row (from the top left) of the glyph for c is set. Characters outside the font are blank.
+int glyphPixel(char c, int column, int row);
+
+//Width in pixels of text drawn at the given scale
+int textWidth(const char* text, int scale);
+
+#endif //PONG_FONT_DATA_H
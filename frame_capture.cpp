@@ -0,0 +1,414 @@
+// Frame capture for video export, see frame_capture.h.
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "frame_capture.h"
+
+int captureFormatForPath(const char* path){
+    size_t length = strlen(path);
+    if (strchr(path, '%') != NULL) {
+        return CAPTURE_PNG;
+    }
+    if (length >= 4 && strcmp(path + length - 4, ".y4m") == 0) {
+        return CAPTURE_Y4M;
+    }
+    return CAPTURE_RAW;
+}
+
+uint8_t clampByte(int value){
+    return (uint8_t) (value < 0 ? 0 : value > 255 ? 255 : value);
+}
+
+//Frames come from GL bottom up, every writer flips them
+
+int writeRawFrame(FrameCapture* capture, const unsigned char* pixels){
+    int width = capture->width;
+    for (int y = capture->height - 1; y >= 0; y--) {
+        const unsigned char* source = pixels + (size_t) y * width * 4;
+        for (int x = 0; x < width; x++) {
+            capture->row[x * 3] = source[x * 4];
+            capture->row[x * 3 + 1] = source[x * 4 + 1];
+            capture->row[x * 3 + 2] = source[x * 4 + 2];
+        }
+        if (fwrite(capture->row, 3, width, capture->file) != (size_t) width) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+//BT.601 full range ("C420jpeg"), chroma averaged over 2x2 blocks
+int writeY4mFrame(FrameCapture* capture, const unsigned char* pixels){
+    int width = capture->width;
+    int height = capture->height;
+    int chromaWidth = (width + 1) / 2;
+    int chromaHeight = (height + 1) / 2;
+    unsigned char* lumaPlane = capture->row;
+    unsigned char* bluePlane = lumaPlane + (size_t) width * height;
+    unsigned char* redPlane = bluePlane + (size_t) chromaWidth * chromaHeight;
+
+    for (int y = 0; y < height; y++) {
+        const unsigned char* source = pixels + (size_t) (height - 1 - y) * width * 4;
+        for (int x = 0; x < width; x++) {
+            const unsigned char* pixel = source + x * 4;
+            lumaPlane[(size_t) y * width + x] = (uint8_t) ((77 * pixel[0] + 150 * pixel[1] + 29 * pixel[2] + 128) >> 8);
+        }
+    }
+    for (int cy = 0; cy < chromaHeight; cy++) {
+        for (int cx = 0; cx < chromaWidth; cx++) {
+            int r = 0;
+            int g = 0;
+            int b = 0;
+            int count = 0;
+            for (int y = cy * 2; y < cy * 2 + 2 && y < height; y++) {
+                for (int x = cx * 2; x < cx * 2 + 2 && x < width; x++) {
+                    const unsigned char* pixel = pixels + ((size_t) (height - 1 - y) * width + x) * 4;
+                    r += pixel[0];
+                    g += pixel[1];
+                    b += pixel[2];
+                    count++;
+                }
+            }
+            r /= count;
+            g /= count;
+            b /= count;
+            bluePlane[(size_t) cy * chromaWidth + cx] = clampByte(128 + ((-43 * r - 85 * g + 128 * b + 128) >> 8));
+            redPlane[(size_t) cy * chromaWidth + cx] = clampByte(128 + ((128 * r - 107 * g - 21 * b + 128) >> 8));
+        }
+    }
+
+    size_t planes = (size_t) width * height + 2 * (size_t) chromaWidth * chromaHeight;
+    if (fputs("FRAME\n", capture->file) < 0 || fwrite(capture->row, 1, planes, capture->file) != planes) {
+        return -1;
+    }
+    return 0;
+}
+
+uint32_t crcTable[256];
+
+void buildCrcTable(){
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t c = n;
+        for (int k = 0; k < 8; k++) {
+            c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+        }
+        crcTable[n] = c;
+    }
+}
+
+uint32_t updateCrc(uint32_t crc, const unsigned char* data, size_t length){
+    for (size_t i = 0; i < length; i++) {
+        crc = crcTable[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+void putBigEndian(unsigned char* out, uint32_t value){
+    out[0] = (unsigned char) (value >> 24);
+    out[1] = (unsigned char) (value >> 16);
+    out[2] = (unsigned char) (value >> 8);
+    out[3] = (unsigned char) value;
+}
+
+//A PNG chunk written in pieces, with the CRC kept as it goes
+typedef struct PngChunk{
+    FILE* file;
+    uint32_t crc;
+    int failed;
+} PngChunk;
+
+void beginChunk(PngChunk* chunk, FILE* file, const char* type, uint32_t length){
+    unsigned char header[8];
+    putBigEndian(header, length);
+    memcpy(header + 4, type, 4);
+    chunk->file = file;
+    chunk->failed = fwrite(header, 1, 8, file) != 8;
+    chunk->crc = updateCrc(0xffffffffu, header + 4, 4);
+}
+
+void chunkData(PngChunk* chunk, const unsigned char* data, size_t length){
+    chunk->failed |= fwrite(data, 1, length, chunk->file) != length;
+    chunk->crc = updateCrc(chunk->crc, data, length);
+}
+
+int endChunk(PngChunk* chunk){
+    unsigned char crc[4];
+    putBigEndian(crc, chunk->crc ^ 0xffffffffu);
+    chunk->failed |= fwrite(crc, 1, 4, chunk->file) != 4;
+    return chunk->failed ? -1 : 0;
+}
+
+//Stored (uncompressed) deflate blocks: the writer thread keeps up with the game at full resolution, at the cost
+//of PNGs the size of the raw frame
+int writePngFrame(FrameCapture* capture, const unsigned char* pixels, long frame){
+    char path[1024];
+    snprintf(path, sizeof(path), capture->path, (int) frame);
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        return -1;
+    }
+
+    int width = capture->width;
+    int height = capture->height;
+    size_t rowSize = 1 + (size_t) width * 3;
+    size_t imageSize = rowSize * height;
+    unsigned char* image = capture->row;
+    for (int y = 0; y < height; y++) {
+        unsigned char* row = image + y * rowSize;
+        const unsigned char* source = pixels + (size_t) (height - 1 - y) * width * 4;
+        row[0] = 0; //No filter
+        for (int x = 0; x < width; x++) {
+            row[1 + x * 3] = source[x * 4];
+            row[2 + x * 3] = source[x * 4 + 1];
+            row[3 + x * 3] = source[x * 4 + 2];
+        }
+    }
+
+    static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    int failed = fwrite(signature, 1, 8, file) != 8;
+
+    unsigned char header[13];
+    putBigEndian(header, (uint32_t) width);
+    putBigEndian(header + 4, (uint32_t) height);
+    header[8] = 8; //Bits per channel
+    header[9] = 2; //RGB
+    header[10] = 0; //Deflate
+    header[11] = 0; //Adaptive filtering
+    header[12] = 0; //Not interlaced
+    PngChunk chunk;
+    beginChunk(&chunk, file, "IHDR", sizeof(header));
+    chunkData(&chunk, header, sizeof(header));
+    failed |= endChunk(&chunk);
+
+    const size_t maxBlock = 65535;
+    size_t blockCount = (imageSize + maxBlock - 1) / maxBlock;
+    beginChunk(&chunk, file, "IDAT", (uint32_t) (2 + blockCount * 5 + imageSize + 4));
+    static const unsigned char zlibHeader[2] = {0x78, 0x01};
+    chunkData(&chunk, zlibHeader, 2);
+    uint32_t adlerA = 1;
+    uint32_t adlerB = 0;
+    for (size_t offset = 0; offset < imageSize; offset += maxBlock) {
+        size_t length = imageSize - offset < maxBlock ? imageSize - offset : maxBlock;
+        unsigned char blockHeader[5];
+        blockHeader[0] = offset + length == imageSize; //Final block flag
+        blockHeader[1] = (unsigned char) length;
+        blockHeader[2] = (unsigned char) (length >> 8);
+        blockHeader[3] = (unsigned char) ~length;
+        blockHeader[4] = (unsigned char) (~length >> 8);
+        chunkData(&chunk, blockHeader, 5);
+        chunkData(&chunk, image + offset, length);
+        for (size_t i = 0; i < length; i++) {
+            adlerA = (adlerA + image[offset + i]) % 65521;
+            adlerB = (adlerB + adlerA) % 65521;
+        }
+    }
+    unsigned char adler[4];
+    putBigEndian(adler, adlerB << 16 | adlerA);
+    chunkData(&chunk, adler, 4);
+    failed |= endChunk(&chunk);
+
+    beginChunk(&chunk, file, "IEND", 0);
+    failed |= endChunk(&chunk);
+    failed |= fclose(file);
+    return failed ? -1 : 0;
+}
+
+void writeFrames(FrameCapture* capture){
+    while (true) {
+        std::unique_lock<std::mutex> guard(capture->lock);
+        capture->changed.wait(guard, [&]{ return capture->fullCount > 0 || capture->stopping; });
+        if (capture->fullCount == 0) {
+            return;
+        }
+        int slot = capture->fullSlots[0];
+        capture->fullCount--;
+        memmove(capture->fullSlots, capture->fullSlots + 1, sizeof(int) * capture->fullCount);
+        int failed = capture->failed;
+        long frame = capture->writtenFrames;
+        guard.unlock();
+
+        if (!failed) {
+            const unsigned char* pixels = capture->slots[slot];
+            switch (capture->format) {
+                case CAPTURE_Y4M:
+                    failed = writeY4mFrame(capture, pixels) != 0;
+                    break;
+                case CAPTURE_PNG:
+                    failed = writePngFrame(capture, pixels, frame) != 0;
+                    break;
+                default:
+                    failed = writeRawFrame(capture, pixels) != 0;
+                    break;
+            }
+        }
+
+        guard.lock();
+        capture->failed |= failed;
+        if (!failed) {
+            capture->writtenFrames++;
+        }
+        capture->freeSlots[capture->freeCount++] = slot;
+        capture->changed.notify_all();
+    }
+}
+
+//Takes a free slot for the next frame, or returns -1 when the frame has to be dropped
+int takeFreeSlot(FrameCapture* capture){
+    std::unique_lock<std::mutex> guard(capture->lock);
+    if (capture->policy == CAPTURE_BLOCK) {
+        capture->changed.wait(guard, [&]{ return capture->freeCount > 0 || capture->failed; });
+    }
+    if (capture->freeCount == 0 || capture->failed) {
+        capture->droppedFrames++;
+        return -1;
+    }
+    return capture->freeSlots[--capture->freeCount];
+}
+
+void queueSlot(FrameCapture* capture, int slot){
+    std::lock_guard<std::mutex> guard(capture->lock);
+    capture->fullSlots[capture->fullCount++] = slot;
+    capture->queuedFrames++;
+    capture->changed.notify_all();
+}
+
+//Queues the frame waiting in a pixel buffer
+void queuePixelBuffer(FrameCapture* capture, GLuint buffer){
+    int slot = takeFreeSlot(capture);
+    if (slot < 0) {
+        return;
+    }
+    size_t size = (size_t) capture->width * capture->height * 4;
+    glf.BindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+    void* pixels = glf.MapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+    if (pixels) {
+        memcpy(capture->slots[slot], pixels, size);
+        glf.UnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glf.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (pixels) {
+        queueSlot(capture, slot);
+    } else {
+        std::lock_guard<std::mutex> guard(capture->lock);
+        capture->freeSlots[capture->freeCount++] = slot;
+        capture->droppedFrames++;
+    }
+}
+
+int startCapture(FrameCapture* capture, const char* path, int width, int height, int fps, int policy){
+    capture->width = width;
+    capture->height = height;
+    capture->format = captureFormatForPath(path);
+    capture->policy = policy;
+    capture->fps = fps;
+    capture->path = path;
+    capture->file = NULL;
+    capture->readFrames = 0;
+    capture->freeCount = 0;
+    capture->fullCount = 0;
+    capture->stopping = 0;
+    capture->queuedFrames = 0;
+    capture->droppedFrames = 0;
+    capture->writtenFrames = 0;
+    capture->failed = 0;
+    buildCrcTable();
+
+    if (capture->format != CAPTURE_PNG) {
+        capture->file = fopen(path, "wb");
+        if (!capture->file) {
+            return -1;
+        }
+    }
+    if (capture->format == CAPTURE_Y4M) {
+        fprintf(capture->file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width, height, fps);
+    }
+
+    size_t frameSize = (size_t) width * height * 4;
+    for (int i = 0; i < captureQueueLength; i++) {
+        capture->slots[i] = (unsigned char*) malloc(frameSize);
+        capture->freeSlots[capture->freeCount++] = i;
+    }
+    //Big enough for a PNG's filtered rows, which is more than the other formats need
+    capture->row = (unsigned char*) malloc((size_t) height * (1 + (size_t) width * 3) + width * 3);
+
+    capture->pixelBuffers[0] = 0;
+    capture->pixelBuffers[1] = 0;
+    if (glf.GenBuffers && glf.BindBuffer && glf.BufferData && glf.MapBufferRange && glf.UnmapBuffer) {
+        glf.GenBuffers(2, capture->pixelBuffers);
+        for (int i = 0; i < 2; i++) {
+            glf.BindBuffer(GL_PIXEL_PACK_BUFFER, capture->pixelBuffers[i]);
+            glf.BufferData(GL_PIXEL_PACK_BUFFER, frameSize, NULL, GL_STREAM_READ);
+        }
+        glf.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    capture->writer = std::thread(writeFrames, capture);
+    return 0;
+}
+
+void captureFrame(FrameCapture* capture){
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    if (!capture->pixelBuffers[0]) {
+        //No buffers to map: read straight into a slot, which waits for the frame to finish
+        int slot = takeFreeSlot(capture);
+        if (slot >= 0) {
+            glReadPixels(0, 0, capture->width, capture->height, GL_RGBA, GL_UNSIGNED_BYTE, capture->slots[slot]);
+            queueSlot(capture, slot);
+        }
+        capture->readFrames++;
+        return;
+    }
+
+    //Starts this frame's transfer, then collects the previous one, which has had a frame's time to finish
+    glf.BindBuffer(GL_PIXEL_PACK_BUFFER, capture->pixelBuffers[capture->readFrames % 2]);
+    glReadPixels(0, 0, capture->width, capture->height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+    glf.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    capture->readFrames++;
+    if (capture->readFrames >= 2) {
+        queuePixelBuffer(capture, capture->pixelBuffers[capture->readFrames % 2]);
+    }
+}
+
+void captureFramePixels(FrameCapture* capture, const void* pixels){
+    int slot = takeFreeSlot(capture);
+    if (slot >= 0) {
+        memcpy(capture->slots[slot], pixels, (size_t) capture->width * capture->height * 4);
+        queueSlot(capture, slot);
+    }
+}
+
+void flushCapture(FrameCapture* capture){
+    if (capture->pixelBuffers[0]) {
+        if (capture->readFrames >= 1) {
+            queuePixelBuffer(capture, capture->pixelBuffers[(capture->readFrames - 1) % 2]);
+        }
+        glf.DeleteBuffers(2, capture->pixelBuffers);
+        capture->pixelBuffers[0] = 0;
+        capture->pixelBuffers[1] = 0;
+    }
+}
+
+int finishCapture(FrameCapture* capture){
+    {
+        std::lock_guard<std::mutex> guard(capture->lock);
+        capture->stopping = 1;
+        capture->changed.notify_all();
+    }
+    capture->writer.join();
+
+    int failed = capture->failed;
+    if (capture->file) {
+        failed |= ferror(capture->file);
+        failed |= fclose(capture->file);
+        capture->file = NULL;
+    }
+    for (int i = 0; i < captureQueueLength; i++) {
+        free(capture->slots[i]);
+        capture->slots[i] = NULL;
+    }
+    free(capture->row);
+    capture->row = NULL;
+    return failed || capture->writtenFrames != capture->queuedFrames ? -1 : 0;
+}
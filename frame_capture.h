@@ -0,0 +1,88 @@
+// Frame capture for video export.
+// Reads finished frames back from the current OpenGL context and hands them to a writer thread, so neither the
+// readback nor the encoding holds up the render loop. Readback goes through two pixel buffer objects: a frame is
+// read into one while the previous frame, whose copy has had a whole frame to finish, is mapped from the other.
+// Frames reach the writer through a bounded queue. When the writer falls behind, CAPTURE_DROP skips frames and
+// CAPTURE_BLOCK waits for a free slot, slowing the caller down to the writer's speed.
+//
+// The output format follows the path: "*.y4m" is a YUV4MPEG2 stream (4:2:0, full range), a path with a printf
+// pattern such as "frames/%05d.png" is numbered PNGs, anything else is raw top down RGB24 frames.
+
+#ifndef PONG_FRAME_CAPTURE_H
+#define PONG_FRAME_CAPTURE_H
+
+#include <condition_variable>
+#include <mutex>
+#include <stdio.h>
+#include <thread>
+
+#include "gl_functions.h"
+
+enum CaptureFormat{
+    CAPTURE_RAW = 0,
+    CAPTURE_Y4M = 1,
+    CAPTURE_PNG = 2
+};
+
+enum CapturePolicy{
+    CAPTURE_DROP = 0, //Skip frames while the queue is full
+    CAPTURE_BLOCK = 1 //Wait for the writer
+};
+
+const int captureQueueLength = 8; //Frames waiting for the writer at most
+
+typedef struct FrameCapture{
+    int width;
+    int height;
+    int format; //CaptureFormat
+    int policy; //CapturePolicy
+    int fps; //Only written to Y4M headers
+    const char* path;
+    FILE* file; //Raw and Y4M output
+
+    GLuint pixelBuffers[2]; //Both 0 when the context can't map buffers, frames are then read synchronously
+    long readFrames; //Frames read back so far, the newest is in pixelBuffers[(readFrames - 1) % 2]
+
+    //Queue slots, each one frame of bottom up RGBA. The caller fills free slots, the writer drains full ones.
+    unsigned char* slots[captureQueueLength];
+    long slotFrame[captureQueueLength]; //Frame number each full slot holds
+    int freeSlots[captureQueueLength];
+    int freeCount;
+    int fullSlots[captureQueueLength]; //In order, the writer takes fullSlots[0] first
+    int fullCount;
+    int stopping;
+    std::mutex lock;
+    std::condition_variable changed;
+    std::thread writer;
+    unsigned char* row; //Writer's scratch for one converted row or frame
+
+    long queuedFrames; //Frames handed to the writer
+    long droppedFrames;
+    long writtenFrames;
+    int failed; //1 once a write has failed, later frames are dropped
+} FrameCapture;
+
+//Opens the output and starts the writer thread. Frames read with captureFrame need the context that will be read
+//to be current here.
+//Returns 0 on success.
+int startCapture(FrameCapture* capture, const char* path, int width, int height, int fps, int policy);
+
+//Reads the current frame from the read buffer (the back buffer before a swap). Call once per frame.
+void captureFrame(FrameCapture* capture);
+
+//Queues a frame that is already in memory, bottom up RGBA like glReadPixels gives, e.g. from the software renderer
+void captureFramePixels(FrameCapture* capture, const void* pixels);
+
+//Hands over the frame still in a pixel buffer and deletes the buffers. Needs the context frames were read from
+//to be current, so call it before the context goes away; calling it again does nothing.
+void flushCapture(FrameCapture* capture);
+
+//Waits for the writer to finish and closes the output. Makes no OpenGL calls, so it can run after the context is
+//gone; a frame not handed over with flushCapture first is lost then.
+//Returns 0 if every frame queued was written.
+int finishCapture(FrameCapture* capture);
+
+//Format startCapture picks for path
+int captureFormatForPath(const char* path);
+
+#endif //PONG_FRAME_CAPTURE_H
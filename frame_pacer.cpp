@@ -0,0 +1,96 @@
+// Frame pacing, see frame_pacer.h.
+
+#include <algorithm>
+#include <time.h>
+
+#include "frame_pacer.h"
+#include "scheduler.h"
+
+void initFramePacer(FramePacer* pacer, int frameRate){
+    pacer->frameSeconds = frameRate > 0 ? 1.0 / frameRate : 0;
+    pacer->lastFrame = 0;
+    pacer->spinMargin = pacerMaxSpin / 2;
+    pacer->start = 0;
+    pacer->stoppedAt = 0;
+    pacer->sleptSeconds = 0;
+    pacer->spunSeconds = 0;
+    pacer->frames = 0;
+}
+
+void waitUntil(FramePacer* pacer, double deadline){
+    double now = schedulerNow();
+    double sleepUntil = deadline - pacer->spinMargin;
+    if (now < sleepUntil) {
+        double seconds = sleepUntil - now;
+        struct timespec duration;
+        duration.tv_sec = (time_t) seconds;
+        duration.tv_nsec = (long) ((seconds - (double) duration.tv_sec) * 1e9);
+        nanosleep(&duration, NULL);
+        double woke = schedulerNow();
+        if (pacer->start > 0) {
+            pacer->sleptSeconds += woke - now;
+        }
+        //Keep the margin at about twice how late sleeps wake, so spinning covers them without spinning long
+        double late = std::max(0.0, woke - sleepUntil);
+        pacer->spinMargin = std::min(pacerMaxSpin, std::max(pacerMinSpin, 0.9 * pacer->spinMargin + 0.2 * late));
+        now = woke;
+    }
+    double spinStart = now;
+    while (now < deadline) {
+        now = schedulerNow();
+    }
+    if (pacer->start > 0) {
+        pacer->spunSeconds += now - spinStart;
+    }
+}
+
+double nextFrameDeadline(const FramePacer* pacer, double nextTick){
+    if (pacer->frameSeconds > 0 && pacer->lastFrame > 0) {
+        return std::min(nextTick, pacer->lastFrame + pacer->frameSeconds);
+    }
+    return nextTick;
+}
+
+int frameDue(const FramePacer* pacer, double now){
+    return pacer->frameSeconds > 0 && now >= pacer->lastFrame + pacer->frameSeconds;
+}
+
+void markFrame(FramePacer* pacer, double now){
+    if (pacer->start == 0) {
+        pacer->start = now;
+    }
+    pacer->lastFrame = now;
+    pacer->frames++;
+}
+
+void stopPacing(FramePacer* pacer, double now){
+    if (pacer->stoppedAt == 0) {
+        pacer->stoppedAt = now;
+    }
+}
+
+void resumePacing(FramePacer* pacer, double now){
+    if (pacer->stoppedAt > 0 && pacer->start > 0) {
+        pacer->start += now - pacer->stoppedAt;
+    }
+    pacer->stoppedAt = 0;
+    pacer->lastFrame = 0;
+}
+
+//Time pacing has been running for
+double pacedSeconds(const FramePacer* pacer, double now){
+    if (pacer->start == 0) {
+        return 0;
+    }
+    return (pacer->stoppedAt > 0 ? pacer->stoppedAt : now) - pacer->start;
+}
+
+double pacerSleepShare(const FramePacer* pacer, double now){
+    double seconds = pacedSeconds(pacer, now);
+    return seconds > 0 ? pacer->sleptSeconds / seconds : 0;
+}
+
+double pacerSpinShare(const FramePacer* pacer, double now){
+    double seconds = pacedSeconds(pacer, now);
+    return seconds > 0 ? pacer->spunSeconds / seconds : 0;
+}
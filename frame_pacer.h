@@ -0,0 +1,50 @@
+// Frame pacing.
+// Waits for the next deadline (the next tick, or the next frame when frames are paced faster than ticks)
+// without keeping a core busy: it sleeps until shortly before the deadline and spins for the rest, which is
+// how it stays on time when sleeps wake up late. How early it stops sleeping adapts to how late the sleeps of
+// this machine turn out to be. Time spent sleeping and spinning is added up so the share of each frame that
+// was idle can be reported.
+
+#ifndef PONG_FRAME_PACER_H
+#define PONG_FRAME_PACER_H
+
+typedef struct FramePacer{
+    double frameSeconds; //Interval frames are drawn at, 0 for one frame per tick
+    double lastFrame; //When the last frame was asked for
+    double spinMargin; //How long before a deadline sleeping stops
+    double start; //When pacing started, 0 until the first frame. Moved forward by the time spent stopped.
+    double stoppedAt; //When pacing was stopped, 0 while it runs
+    //Totals since start
+    double sleptSeconds;
+    double spunSeconds;
+    long frames;
+} FramePacer;
+
+const double pacerMinSpin = 0.0001; //Seconds
+const double pacerMaxSpin = 0.002;
+
+//frameRate 0 draws one frame per tick
+void initFramePacer(FramePacer* pacer, int frameRate);
+
+//Returns once deadline (seconds on schedulerNow's clock) has passed
+void waitUntil(FramePacer* pacer, double deadline);
+
+//The earliest of nextTick and the next frame
+double nextFrameDeadline(const FramePacer* pacer, double nextTick);
+
+//1 if a frame is due at now even without a tick, to draw the state between ticks
+int frameDue(const FramePacer* pacer, double now);
+
+//Notes that a frame was asked for at now
+void markFrame(FramePacer* pacer, double now);
+
+//Stops and restarts pacing, e.g. while paused or on a screen that doesn't change. The time in between isn't
+//counted in the shares.
+void stopPacing(FramePacer* pacer, double now);
+void resumePacing(FramePacer* pacer, double now);
+
+//Shares of the time since pacing started spent sleeping and spinning, from 0 to 1
+double pacerSleepShare(const FramePacer* pacer, double now);
+double pacerSpinShare(const FramePacer* pacer, double now);
+
+#endif //PONG_FRAME_PACER_H
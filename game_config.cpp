@@ -0,0 +1,99 @@
+// Arena and gameplay configuration, see game_config.h.
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "game_config.h"
+
+const NamedArena arenas[arenaCount] = {
+    {"standard", StandardArena::get()},
+    {"small", SmallArena::get()},
+    {"wide", WideArena::get()},
+};
+
+const GameConfig* findArena(const char* name){
+    for (int i = 0; i < arenaCount; i++) {
+        if (strcmp(arenas[i].name, name) == 0) {
+            return &arenas[i].config;
+        }
+    }
+    return NULL;
+}
+
+int sameGameConfig(const GameConfig* a, const GameConfig* b){
+    return memcmp(a, b, sizeof(GameConfig)) == 0;
+}
+
+//Where each key of a config file goes
+typedef struct ConfigKey{
+    const char* name;
+    size_t offset;
+} ConfigKey;
+
+const ConfigKey configKeys[] = {
+    {"width", offsetof(GameConfig, width)},
+    {"height", offsetof(GameConfig, height)},
+    {"paddleInset", offsetof(GameConfig, paddleInset)},
+    {"paddleWidth", offsetof(GameConfig, paddleWidth)},
+    {"paddleLength", offsetof(GameConfig, paddleLength)},
+    {"ballSideLength", offsetof(GameConfig, ballSideLength)},
+    {"ballSpeed", offsetof(GameConfig, ballSpeed)},
+    {"aiPaddleSpeed", offsetof(GameConfig, aiPaddleSpeed)},
+    {"wallThickness", offsetof(GameConfig, wallThickness)},
+    {"goalHeight", offsetof(GameConfig, goalHeight)},
+    {"winningScore", offsetof(GameConfig, winningScore)},
+};
+
+int loadGameConfig(const char* path, GameConfig* config){
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        return -1;
+    }
+    *config = StandardArena::get();
+    char line[256];
+    int result = 0;
+    while (result == 0 && fgets(line, sizeof(line), file)) {
+        char key[64];
+        int value;
+        char* comment = strchr(line, '#');
+        if (comment) {
+            *comment = 0;
+        }
+        int fields = sscanf(line, "%63s %d", key, &value);
+        if (fields <= 0) {
+            continue;
+        }
+        result = -1;
+        for (size_t i = 0; fields == 2 && i < sizeof(configKeys) / sizeof(configKeys[0]); i++) {
+            if (strcmp(key, configKeys[i].name) == 0) {
+                *(int*) ((char*) config + configKeys[i].offset) = value;
+                result = 0;
+            }
+        }
+    }
+    fclose(file);
+
+    //The ball has to fit between the walls and the paddles inside the field, and scripted input needs room
+    int playable = config->width > 4 * (config->paddleInset + config->paddleWidth) && config->ballSideLength > 0
+                   && config->ballSpeed > 0 && config->paddleLength > 0 && config->winningScore > 0
+                   && config->height - 2 * config->wallThickness > config->paddleLength;
+    return result == 0 && playable ? 0 : -1;
+}
+
+long playConfiguredMatch(const GameConfig* config, Global* state, long phase, long maxTicks, int* constant){
+    //Dispatched once per match, so the loop itself never checks which arena it is in
+    *constant = 1;
+    if (sameGameConfig(config, &arenas[0].config)) {
+        return playArenaMatch(StandardArena(), state, phase, maxTicks);
+    }
+    if (sameGameConfig(config, &arenas[1].config)) {
+        return playArenaMatch(SmallArena(), state, phase, maxTicks);
+    }
+    if (sameGameConfig(config, &arenas[2].config)) {
+        return playArenaMatch(WideArena(), state, phase, maxTicks);
+    }
+    *constant = 0;
+    return playArenaMatch(RuntimeArena{config}, state, phase, maxTicks);
+}
@@ -0,0 +1,231 @@
+// Arena and gameplay configuration.
+// simulation.h fixes one 1920x1080 arena in #defines and consts, which the asm kernels read. A GameConfig holds
+// the same values for any arena, and the step functions here run a match from one, in C++ on a Global.
+//
+// The match loop is a template over where the configuration comes from. An arena type whose get() is constexpr
+// (StandardArena and the other built in ones) gives an instantiation where every value is a constant, folded
+// into the loop just like the #defines are. RuntimeArena reads a GameConfig made at run time (loadGameConfig)
+// through the generic instantiation, where the values are loaded once per match and kept in registers.
+// playConfiguredMatch picks the constant instantiation whenever a config matches a built in arena.
+//
+// With the standard arena the step functions give exactly the same states as mouse() followed by gameLogic().
+// They are the one copy of the game's rules that works on any Global: the portable kernels, tournaments and
+// rollback all step through them with StandardArena::get(), which folds to the constants of simulation.h.
+
+#ifndef PONG_GAME_CONFIG_H
+#define PONG_GAME_CONFIG_H
+
+#include "simulation.h"
+
+typedef struct GameConfig{
+    int width; //Pixels
+    int height;
+    int paddleInset; //From the side of the screen to the outer edge of each paddle
+    int paddleWidth;
+    int paddleLength;
+    int ballSideLength;
+    int ballSpeed; //Pixels/Tick on each axis, also how close the AI lets the ball get before it moves
+    int aiPaddleSpeed;
+    int wallThickness;
+    int goalHeight;
+    int winningScore;
+} GameConfig;
+
+//The arena of simulation.h
+struct StandardArena{
+    static constexpr GameConfig get(){
+        return GameConfig{screenWidth, screenHeight, paddleOffset, paddleWidth, paddleLength, ballSideLength,
+                          initialBallSpeed, aiPaddleSpeed, wallThickness, goalHeight, winningScore};
+    }
+};
+
+//720p, everything scaled by two thirds except the ball, which is a little smaller: at 20 pixels the diagonal
+//ball falls into rallies neither side ever wins
+struct SmallArena{
+    static constexpr GameConfig get(){
+        return GameConfig{1280, 720, 80, 27, 133, 18, 20, 20, 13, 240, winningScore};
+    }
+};
+
+//Ultrawide: the standard arena stretched to 2560 pixels
+struct WideArena{
+    static constexpr GameConfig get(){
+        return GameConfig{2560, screenHeight, paddleOffset, paddleWidth, paddleLength, ballSideLength,
+                          initialBallSpeed, aiPaddleSpeed, wallThickness, goalHeight, winningScore};
+    }
+};
+
+//A configuration known only at run time
+struct RuntimeArena{
+    const GameConfig* config;
+    GameConfig get() const {
+        return *config;
+    }
+};
+
+typedef struct NamedArena{
+    const char* name;
+    GameConfig config;
+} NamedArena;
+
+const int arenaCount = 3;
+extern const NamedArena arenas[arenaCount];
+
+//The built in arena called name, NULL if there is none
+const GameConfig* findArena(const char* name);
+
+//Reads "key value" lines (keys as in GameConfig, # starts a comment) over the standard arena.
+//Returns 0 on success, -1 if the file can't be read or holds an unknown key or an unplayable arena.
+int loadGameConfig(const char* path, GameConfig* config);
+
+int sameGameConfig(const GameConfig* a, const GameConfig* b);
+
+//initGlobals() for config, past the intro screen
+inline void initArenaState(Global* state, const GameConfig& config){
+    state->playerPaddlePosition = (Point){config.width - config.paddleInset - config.paddleWidth,
+                                          config.height / 2 - config.paddleLength / 2};
+    state->aiPaddlePosition = (Point){config.paddleInset, config.height / 2 - config.paddleLength / 2};
+    state->playerScore = 0;
+    state->aiScore = 0;
+    state->ballPosition = (Point){config.width / 2, config.height / 2};
+    state->ballSpeed = config.ballSpeed;
+    state->ballDirection = initialBallDirection;
+    state->lastScore = 0;
+    state->gameOver = 0;
+    state->introScreen = 1;
+}
+
+//scriptedPlayerY() for config
+inline int arenaScriptedY(long tick, const GameConfig& config){
+    const int top = config.wallThickness + config.paddleLength / 2;
+    const int bottom = config.height - config.wallThickness - config.paddleLength / 2;
+    const int range = bottom - top;
+    int phase = (int) ((tick * 107 / 3) % (2 * range));
+    return phase < range ? top + phase : bottom - (phase - range);
+}
+
+//Boxes touch, edges inclusive, on one axis
+inline bool arenaOverlap(int a1, int a2, int b1, int b2){
+    return (b1 <= a1 && a1 <= b2) || (b1 <= a2 && a2 <= b2);
+}
+
+//resetBall() on state with config: the ball back in the middle, served away from whoever scored last
+inline void arenaResetBall(Global* state, const GameConfig& config){
+    state->ballPosition = (Point){config.width / 2, config.height / 2};
+    state->ballDirection = (Point){state->lastScore == 0 ? -initialBallDirection.x : initialBallDirection.x,
+                                   initialBallDirection.y};
+    state->ballSpeed = config.ballSpeed;
+}
+
+//updateBall()'s paddle test, for a ball with its top left corner at (x, y)
+inline bool arenaPaddleHit(int x, int y, Point paddle, const GameConfig& config){
+    return arenaOverlap(x, x + config.ballSideLength, paddle.x, paddle.x + config.paddleWidth)
+           && arenaOverlap(y, y + config.ballSideLength, paddle.y, paddle.y + config.paddleLength);
+}
+
+//The walls a ball with its top left corner at (x, y) is at or past. It bounces off every one of them, and
+//scores on the left or right one if it's in the goal.
+typedef struct ArenaWalls{
+    bool ceiling;
+    bool floor;
+    bool left;
+    bool right;
+} ArenaWalls;
+
+inline ArenaWalls arenaWalls(int x, int y, const GameConfig& config){
+    return ArenaWalls{y <= config.wallThickness, y >= config.height - config.wallThickness,
+                      x <= config.wallThickness, x >= config.width - config.wallThickness};
+}
+
+//A ball at y past the ceiling or the floor is put back on it before it moves
+inline int arenaClampY(int y, const ArenaWalls& walls, const GameConfig& config){
+    return walls.ceiling ? config.wallThickness : walls.floor ? config.height - config.wallThickness : y;
+}
+
+//The whole side of a ball at y is within the goal mouth
+inline bool arenaInGoal(int y, const GameConfig& config){
+    int goalTop = config.height / 2 - config.goalHeight / 2;
+    int goalBottom = config.height / 2 + config.goalHeight / 2;
+    int y2 = y + config.ballSideLength;
+    return y >= goalTop && y <= goalBottom && y2 >= goalTop && y2 <= goalBottom;
+}
+
+//updateBall() on state with config
+inline void arenaUpdateBall(Global* state, const GameConfig& config){
+    int x = state->ballPosition.x;
+    int y = state->ballPosition.y;
+    if (arenaPaddleHit(x, y, state->playerPaddlePosition, config)
+        || arenaPaddleHit(x, y, state->aiPaddlePosition, config)) {
+        state->ballDirection.x = -state->ballDirection.x;
+    }
+    ArenaWalls walls = arenaWalls(x, y, config);
+    if (walls.ceiling || walls.floor) {
+        state->ballDirection.y = -state->ballDirection.y;
+    }
+    if (walls.left || walls.right) {
+        state->ballDirection.x = -state->ballDirection.x;
+    }
+    state->ballPosition.y = arenaClampY(y, walls, config);
+    if (arenaInGoal(y, config) && (walls.left || walls.right)) {
+        state->playerScore += walls.left;
+        state->aiScore += !walls.left;
+        state->lastScore = walls.left;
+        arenaResetBall(state, config);
+    } else {
+        state->ballPosition.x += state->ballDirection.x * state->ballSpeed;
+        state->ballPosition.y += state->ballDirection.y * state->ballSpeed;
+    }
+}
+
+//updateAI() on state with config: while the ball is on its half, the AI paddle moves toward it unless it's within
+//a ball speed
+inline void arenaUpdateAI(Global* state, const GameConfig& config){
+    if (state->ballPosition.x + config.ballSideLength >= (config.width >> 1)) {
+        return;
+    }
+    int distance = state->ballPosition.y + (config.ballSideLength >> 1) - (config.paddleLength >> 1)
+                   - state->aiPaddlePosition.y;
+    if (distance > config.ballSpeed) {
+        state->aiPaddlePosition.y += config.aiPaddleSpeed;
+    } else if (distance < -config.ballSpeed) {
+        state->aiPaddlePosition.y -= config.aiPaddleSpeed;
+    }
+}
+
+//The end of gameLogic(): the match is over once either side has winningScore
+inline void arenaCheckGameOver(Global* state, const GameConfig& config){
+    if (state->playerScore >= config.winningScore || state->aiScore >= config.winningScore) {
+        state->gameOver = 1;
+    }
+}
+
+//mouse(0, mouseY) then gameLogic(), on state with config
+inline void stepArena(Global* state, int mouseY, const GameConfig& config){
+    state->playerPaddlePosition.y = mouseY - (config.paddleLength >> 1);
+    if (state->gameOver) {
+        return;
+    }
+    arenaUpdateBall(state, config);
+    arenaUpdateAI(state, config);
+    arenaCheckGameOver(state, config);
+}
+
+//Plays a match on state against the scripted player, starting phase ticks into its script. Returns the ticks
+//played. The configuration is read once, so with a constexpr Arena every value is a constant in the loop.
+template <class Arena>
+long playArenaMatch(const Arena& arena, Global* state, long phase, long maxTicks){
+    const GameConfig config = arena.get();
+    initArenaState(state, config);
+    long tick = 0;
+    while (state->gameOver == 0 && tick < maxTicks) {
+        stepArena(state, arenaScriptedY(tick + phase, config), config);
+        tick++;
+    }
+    return tick;
+}
+
+//playArenaMatch with the constant instantiation of the built in arena config matches, or the runtime one.
+//Sets *constant to 1 if a constant instantiation was used.
+long playConfiguredMatch(const GameConfig* config, Global* state, long phase, long maxTicks, int* constant);
+
+#endif //PONG_GAME_CONFIG_H
@@ -0,0 +1,231 @@
+// Game scene, see game_scene.h.
+
+#include <stdio.h>
+
+#include "font_data.h"
+#include "game_scene.h"
+#include "profiler.h"
+#include "scheduler.h"
+
+const SceneOutput* sceneOutput = NULL;
+
+const Color paddleColor = (Color){255, 255, 255};
+
+//Frame rate overlay, turned on with --fps
+int showOverlay = 0;
+long overlayTickRate = 0;
+long overlaySleepPercent = -1;
+long framesPerSecond = 0;
+long framesCounted = 0;
+double fpsWindowStart = 0;
+
+int showPaused = 0;
+
+//Timing overlay, needs a build with PONG_ENABLE_PROFILING
+const int profileOverlayLines = 16;
+int showProfile = 0;
+ProfileStat profileStatsShown[profileOverlayLines];
+int profileStatCount = 0;
+double profileStatsTime = 0;
+
+void drawRect(int x1, int y1, int x2, int y2, Color color){
+    sceneOutput->rect(x1, y1, x2, y2, color);
+}
+
+void drawNumber(long value, int x, int y, int scale, Color color){
+    char number[24];
+    snprintf(number, sizeof(number), "%ld", value);
+    sceneOutput->text(number, x, y, scale, color);
+}
+
+void drawBall(const Global* state){
+    PROFILE_SCOPE("drawBall");
+    //The ball is a square with a side length of ballSideLength, placed at state->ballPosition
+    int x = state->ballPosition.x;
+    int y = state->ballPosition.y;
+    drawRect(x, y, x + ballSideLength, y + ballSideLength, paddleColor);
+}
+
+void drawPaddle(const Global* state){
+    PROFILE_SCOPE("drawPaddle");
+    //Draws the player paddle and the AI paddle
+    //The paddle is a rectangle with a width of paddleWidth and a length of paddleLength
+    //Both paddles are white
+    //The player paddle is on the right, the AI paddle is on the left
+    //The paddles are placed at state->playerPaddlePosition and state->aiPaddlePosition
+
+    //draw player
+    Point player = state->playerPaddlePosition;
+    drawRect(player.x, player.y, player.x + paddleWidth, player.y + paddleLength, paddleColor);
+
+    //draw AI
+    Point ai = state->aiPaddlePosition;
+    drawRect(ai.x, ai.y, ai.x + paddleWidth, ai.y + paddleLength, paddleColor);
+}
+
+void drawScore(const Global* state){
+    PROFILE_SCOPE("drawScore");
+    //Draws the score for both the player and the AI
+    //Player score is green, AI score is red
+    //Player score is on the right, AI score is on the left
+    //Score is drawn as a series of squares
+    //The number of squares is equal to the score
+    //The squares are drawn in a row, with the scoreGap between each square
+    //The squares have a side length of scoreSize
+
+    Color playerColor = (Color){0, 255, 0};
+    int y1 =aiScorePosition.y;
+    int y2 =y1 + scoreSize;
+
+    //draw players score
+    for (int i = 1; i <= state->playerScore; i++ ) {
+        int x1 = screenWidth - (wallThickness + (scoreSize + scoreGap) * i);
+        drawRect(x1, y1, x1 + scoreSize, y2, playerColor);
+    }
+
+    //draw AIs score
+    Color aiColor = (Color){255, 0, 0};
+    for (int i = 1; i <= state->aiScore; i++ ) {
+        int x1 = wallThickness + (scoreSize + scoreGap) * i;
+        drawRect(x1, y1, x1 + scoreSize, y2, aiColor);
+    }
+}
+
+void drawWalls(){
+    PROFILE_SCOPE("drawWalls");
+    //top wall
+    drawRect(0, 0, screenWidth, wallThickness, paddleColor);
+    //bottom wall
+    drawRect(0, screenHeight - wallThickness, screenWidth, screenHeight, paddleColor);
+
+    //right bottom
+    drawRect(screenWidth - wallThickness, screenHeight - goalHeight, screenWidth, screenHeight, paddleColor);
+    //right top
+    drawRect(screenWidth - wallThickness, 0, screenWidth, goalHeight, paddleColor);
+
+    //left bottom
+    drawRect(0, screenHeight - goalHeight, wallThickness, screenHeight, paddleColor);
+    //left top
+    drawRect(0, 0, wallThickness, goalHeight, paddleColor);
+}
+
+
+void drawMidfieldLine() {
+    PROFILE_SCOPE("drawMidfieldLine");
+    int lineSegs = 50;
+    int lineSegSize = 10;
+    Color midlineColor = (Color){100,100,255};
+
+    for (int i = 0; i< lineSegs ; i++) {
+        int y = i * (screenHeight / lineSegs);
+        drawRect(screenWidth/2, y, screenWidth/2 + lineSegSize, y + lineSegSize, midlineColor);
+    }
+}
+
+
+void drawString(const char* message, int x, int y, Color color) {
+    //Draws message centered on x with its baseline at y
+    sceneOutput->text(message, x - textWidth(message, textScale) / 2, y, textScale, color);
+}
+
+void drawMessageGameOver() {
+    PROFILE_SCOPE("drawMessageGameOver");
+    //displays the message for game over
+
+    //draw game over
+
+
+    const char* msg1 = "End of Game!";
+    drawString(msg1, screenWidth / 2, screenHeight / 2, (Color){255, 255, 255});
+
+
+    //draw message for restart
+
+    const char* msg2 = "Press any key to end.";
+    drawString(msg2, screenWidth / 2, screenHeight / 2 + 60, (Color){255, 255, 0});
+
+    const char* msg3 = "Press r to restart.";
+    drawString(msg3, screenWidth / 2, screenHeight / 2 + 90, (Color){255, 255, 0});
+
+}
+
+void drawOverlay(const Global* state){
+    PROFILE_SCOPE("drawOverlay");
+    //Frame rate, tick rate and score as numbers, in the top left corner
+    Color overlayColor = (Color){255, 255, 0};
+    int scale = 2;
+    int x = wallThickness + 20;
+    int y = wallThickness + 30;
+    int lineHeight = glyphHeight * scale + 8;
+
+    sceneOutput->text("FPS", x, y, scale, overlayColor);
+    drawNumber(framesPerSecond, x + textWidth("FPS ", scale), y, scale, overlayColor);
+    sceneOutput->text("TICK", x, y + lineHeight, scale, overlayColor);
+    drawNumber(overlayTickRate, x + textWidth("TICK ", scale), y + lineHeight, scale, overlayColor);
+    sceneOutput->text("SCORE", x, y + 2 * lineHeight, scale, overlayColor);
+    drawNumber(state->aiScore, x + textWidth("SCORE ", scale), y + 2 * lineHeight, scale, overlayColor);
+    drawNumber(state->playerScore, x + textWidth("SCORE 0 ", scale), y + 2 * lineHeight, scale, overlayColor);
+    if (overlaySleepPercent >= 0) {
+        sceneOutput->text("SLEEP", x, y + 3 * lineHeight, scale, overlayColor);
+        drawNumber(overlaySleepPercent, x + textWidth("SLEEP ", scale), y + 3 * lineHeight, scale, overlayColor);
+    }
+}
+
+void drawProfileOverlay(){
+    //p50 and p99 of every zone in microseconds, below the frame rate overlay. The numbers are refreshed twice
+    //a second, working them out takes longer than drawing a frame.
+    PROFILE_SCOPE("drawProfileOverlay");
+    double now = schedulerNow();
+    if (now - profileStatsTime >= 0.5) {
+        profileStatCount = profileStats(profileStatsShown, profileOverlayLines);
+        profileStatsTime = now;
+    }
+
+    Color overlayColor = (Color){128, 255, 128};
+    int scale = 2;
+    int x = wallThickness + 20;
+    int lineHeight = glyphHeight * scale + 8;
+    int y = wallThickness + 30 + 4 * lineHeight;
+    char line[64];
+    sceneOutput->text("ZONE               P50 US   P99 US", x, y, scale, overlayColor);
+    for (int i = 0; i < profileStatCount; i++) {
+        const ProfileStat* stat = &profileStatsShown[i];
+        snprintf(line, sizeof(line), "%-18.18s %7.1f %8.1f", stat->name, stat->p50, stat->p99);
+        sceneOutput->text(line, x, y + (i + 1) * lineHeight, scale, overlayColor);
+    }
+}
+
+void countFrame(){
+    //Updates framesPerSecond twice a second
+    double now = schedulerNow();
+    framesCounted++;
+    if (fpsWindowStart == 0) {
+        fpsWindowStart = now;
+    } else if (now - fpsWindowStart >= 0.5) {
+        framesPerSecond = (long) (framesCounted / (now - fpsWindowStart) + 0.5);
+        framesCounted = 0;
+        fpsWindowStart = now;
+    }
+}
+
+void drawIntroText(){
+    sceneOutput->text("PONG!", screenWidth / 2 - 200, screenHeight / 2 - 10, textScale, (Color){255, 255, 255});
+    sceneOutput->text("Press any button to play", screenWidth / 2 - 200, screenHeight / 2 + 40, textScale,
+                      (Color){255, 255, 128});
+}
+
+void drawSceneText(const Global* state, const Global* view){
+    if (state->gameOver == 1) {
+        drawMessageGameOver();
+    } else if (showPaused) {
+        drawString("Paused", screenWidth / 2, screenHeight / 2, (Color){255, 255, 255});
+        drawString("Press p to carry on.", screenWidth / 2, screenHeight / 2 + 60, (Color){255, 255, 0});
+    }
+    if (showOverlay) {
+        countFrame();
+        drawOverlay(view);
+    }
+    if (showProfile) {
+        drawProfileOverlay();
+    }
+}
@@ -0,0 +1,41 @@
+// Game scene, without a renderer.
+// What a frame of the game shows, as rects and text in pixel coordinates. The backend in use supplies the
+// functions that draw them through sceneOutput: game_view draws with OpenGL, soft_renderer rasterizes into
+// memory. The intro screen's 3D scene is not part of it, only its text.
+
+#ifndef PONG_GAME_SCENE_H
+#define PONG_GAME_SCENE_H
+
+#include "color.h"
+#include "simulation.h"
+
+typedef struct SceneOutput{
+    void (*rect)(int x1, int y1, int x2, int y2, Color color); //Covers [x1, x2) x [y1, y2)
+    void (*text)(const char* text, int x, int y, int scale, Color color); //Left end at x, baseline at y
+} SceneOutput;
+extern const SceneOutput* sceneOutput;
+
+const int textScale = 3; //Screen pixels per font pixel
+
+//Frame rate overlay, and the tick rate it shows
+extern int showOverlay;
+extern long overlayTickRate;
+extern long overlaySleepPercent; //Share of the time the game loop slept, -1 to leave it out
+
+//Message over a paused game
+extern int showPaused;
+
+//Zone timing overlay, needs a build with PONG_ENABLE_PROFILING
+extern int showProfile;
+
+void drawBall(const Global* state);
+void drawPaddle(const Global* state);
+void drawScore(const Global* state);
+void drawWalls();
+void drawMidfieldLine();
+void drawIntroText();
+
+//Text drawn over the game: the game over message for state, and the overlays that are turned on
+void drawSceneText(const Global* state, const Global* view);
+
+#endif //PONG_GAME_SCENE_H
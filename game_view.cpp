@@ -0,0 +1,230 @@
+// Drawing of the game, see game_view.h.
+
+#include <GL/glu.h>
+#include <stdio.h>
+
+#include "game_view.h"
+#include "intro_scene.h"
+#include "profiler.h"
+
+//Collects the rects of a frame and draws them in one call
+RectRenderer rects;
+
+//Geometry that doesn't move is cached on the GPU: the midfield line and walls are built once,
+//the score pips only when a score changes. Only the ball and paddles are submitted every frame.
+RectLayer midfieldLayer;
+RectLayer wallLayer;
+RectLayer scoreLayer;
+int scoreLayerPlayerScore = -1; //Scores scoreLayer was built for
+int scoreLayerAiScore = -1;
+
+//Layer drawRect adds to, NULL to queue for this frame only
+RectLayer* rectTarget = NULL;
+
+//Glyph atlas text, drawn once per frame
+TextRenderer text;
+
+//Display list of the intro screen, 0 until it is built
+GLuint introList = 0;
+
+//Helper functions to convert from pixel coordinates into screen space, which OpenGl expects.
+//You should use these functions to convert your pixel coordinates into screen space.
+//We use pixel coordinates because it is easier to work with in assembly, than floating point numbers.
+float pixelToScreenX(int x){
+    return (2.0f * (float) x / (float) (screenWidth - 1) - 1.0f);
+}
+float pixelToScreenY(int y){
+    return -(2.0f * (float) y / (float) (screenHeight - 1) - 1.0f);
+}
+
+void queueRect(int x1, int y1, int x2, int y2, Color color){
+    //Queues a rect from (x1, y1) to (x2, y2) in pixels. Nothing is drawn until flushRects,
+    //which submits every rect queued this frame in a single draw call.
+    //While a layer is being built the rect goes into rectTarget instead.
+    if (rectTarget != NULL) {
+        addLayerRect(rectTarget, x1, y1, x2 - x1, y2 - y1, color);
+        return;
+    }
+    pushRect(&rects, x1, y1, x2 - x1, y2 - y1, color);
+}
+
+void queueText(const char* message, int x, int y, int scale, Color color){
+    //Drawn with the rest of the frame's text by flushText
+    drawText(&text, message, x, y, scale, color);
+}
+
+const SceneOutput glSceneOutput = {queueRect, queueText};
+
+void buildStaticLayers(){
+    initRectLayer(&midfieldLayer, 64);
+    initRectLayer(&wallLayer, 8);
+    initRectLayer(&scoreLayer, 2 * winningScore);
+
+    rectTarget = &midfieldLayer;
+    drawMidfieldLine();
+    rectTarget = &wallLayer;
+    drawWalls();
+    rectTarget = NULL;
+}
+
+void updateScoreLayer(const Global* state){
+    PROFILE_SCOPE("updateScoreLayer");
+    //Rebuilds the score pips, only when a score has changed since the last build
+    if (state->playerScore == scoreLayerPlayerScore && state->aiScore == scoreLayerAiScore) {
+        return;
+    }
+    clearRectLayer(&scoreLayer);
+    rectTarget = &scoreLayer;
+    drawScore(state);
+    rectTarget = NULL;
+    scoreLayerPlayerScore = state->playerScore;
+    scoreLayerAiScore = state->aiScore;
+}
+
+void recordIntroScreen() {
+    //Everything the intro screen draws. Only called while compiling introList.
+    glEnable(GL_DEPTH_TEST);
+
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    gluPerspective(45, 1, 1, 100);
+
+
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+    gluLookAt(5, 5, 10, 0, 0, 0, 0, 1, 0);
+
+
+
+    // Set up the lighting and material properties
+    GLfloat light_position[] = { 1.0f, 2.0f, -2.0f, 0.0f };
+    glLightfv(GL_LIGHT0, GL_POSITION, light_position);
+    glEnable(GL_LIGHTING);
+    glEnable(GL_LIGHT0);
+    GLfloat mat_ambient[] = { 0.5f, 0.5f, 0.5f, 1.0f };
+    GLfloat mat_diffuse[] = { 0.8f, 0.8f, 0.8f, 1.0f };
+    GLfloat mat_specular[] = { 0.5f, 0.5f, 0.5f, 1.0f };
+    GLfloat mat_shininess[] = { 50.0f };
+    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, mat_ambient);
+    glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, mat_diffuse);
+    glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, mat_specular);
+    glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS, mat_shininess);
+
+    glEnable(GL_CULL_FACE);
+//    glCullFace(GL_BACK);
+
+    // Draw the sphere
+    glPushMatrix();
+    glScalef(0.5,0.5,0.5);
+    glTranslatef(0.0f,  0.0f, -0.0f);
+    drawSolidSphere(1.5, 30, 30);
+    glPopMatrix();
+
+    GLfloat mat_diffuse2[] = { 0.0f, 0.0f, 1.0f, 1.0f };
+    glMaterialfv(GL_FRONT, GL_DIFFUSE, mat_diffuse2);
+
+    // Draw the left rectangular prism
+    glPushMatrix();
+    glTranslatef(-4.0f, 0.0f, 0.0f); // position on the left side of the screen
+    glScalef(0.5f, 2.0f, 0.5f); // stretch into a rectangular prism
+    glColor3f(1.0f, 0.0f, 0.0f); // red color
+    drawSolidCube(2.0f); // draw the cube
+    glPopMatrix();
+
+
+    GLfloat mat_diffuse3[] = { 1.0f, 0.0f, 0.0f, 1.0f };
+    glMaterialfv(GL_FRONT, GL_DIFFUSE, mat_diffuse3);
+
+    // Draw the left rectangular prism
+    glPushMatrix();
+    glTranslatef(3.0f, 0.0f, 0.0f); // position on the left side of the screen
+    glScalef(0.5f, 2.0f, 0.5f); // stretch into a rectangular prism
+    glColor3f(1.0f, 0.0f, 0.0f); // red color
+    drawSolidCube(2.0f); // draw the cube
+    glPopMatrix();
+
+    glDisable(GL_LIGHTING);
+
+    // Restore the previous matrices
+
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+
+
+    glDisable(GL_CULL_FACE);
+}
+
+void drawIntroScreen() {
+    PROFILE_SCOPE("drawIntroScreen");
+    //The intro scene never changes, so it is compiled into a display list on the first draw
+    //and replayed after that. The text goes through the glyph atlas like all other text.
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    if (introList == 0) {
+        introList = glGenLists(1);
+        glNewList(introList, GL_COMPILE);
+        recordIntroScreen();
+        glEndList();
+    }
+    glCallList(introList);
+
+    drawIntroText();
+    flushText(&text);
+    glFlush();
+}
+
+int initGameView(int forceImmediate){
+    sceneOutput = &glSceneOutput;
+    int mode = initRectRenderer(&rects, screenWidth, screenHeight, forceImmediate);
+    buildStaticLayers();
+    initTextRenderer(&text, screenWidth, screenHeight, forceImmediate);
+    scoreLayerPlayerScore = -1;
+    scoreLayerAiScore = -1;
+    return mode;
+}
+
+void destroyGameView(){
+    destroyTextRenderer(&text);
+    destroyRectLayer(&midfieldLayer);
+    destroyRectLayer(&wallLayer);
+    destroyRectLayer(&scoreLayer);
+    destroyRectRenderer(&rects);
+    if (introList != 0) {
+        glDeleteLists(introList, 1);
+        introList = 0;
+    }
+}
+
+void drawGameView(const Global* state, const Global* view){
+    sceneOutput = &glSceneOutput;
+    glClear(GL_COLOR_BUFFER_BIT);
+//    printf("%d", global.aiScore);
+    beginText(&text);
+    if (state->introScreen == 0) {
+        drawIntroScreen();
+        return;
+    }
+
+    //Same back to front order as before the layers: midfield line, paddles and ball, score, walls
+    beginRects(&rects);
+    drawRectLayer(&rects, &midfieldLayer);
+    drawPaddle(view);
+    drawBall(view);
+    {
+        PROFILE_SCOPE("flushRects");
+        flushRects(&rects);
+    }
+    updateScoreLayer(view);
+    {
+        PROFILE_SCOPE("drawRectLayers");
+        drawRectLayer(&rects, &scoreLayer);
+        drawRectLayer(&rects, &wallLayer);
+    }
+    drawSceneText(state, view);
+    {
+        PROFILE_SCOPE("flushText");
+        flushText(&text);
+    }
+}
+
@@ -0,0 +1,27 @@
+// Drawing of the game, without GLUT.
+// Renders a Global into whatever OpenGL context is current, so the same code draws the GLUT window and the
+// offscreen frames of pong_bench. Needs loadGLFunctions() to have been called for the context.
+
+#ifndef PONG_GAME_VIEW_H
+#define PONG_GAME_VIEW_H
+
+#include "game_scene.h"
+#include "rect_renderer.h"
+#include "text_renderer.h"
+
+extern RectRenderer rects;
+extern TextRenderer text;
+
+//Sets up the renderers and the static layers. Returns the RectRendererMode in use.
+int initGameView(int forceImmediate);
+void destroyGameView();
+
+//Helper functions to convert from pixel coordinates into screen space, which OpenGl expects
+float pixelToScreenX(int x);
+float pixelToScreenY(int y);
+
+//Draws one frame: the intro screen if state is on it, otherwise the game at view (state interpolated
+//between ticks) and the messages and overlays for state. Doesn't swap buffers.
+void drawGameView(const Global* state, const Global* view);
+
+#endif //PONG_GAME_VIEW_H
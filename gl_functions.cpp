@@ -0,0 +1,111 @@
+// OpenGL entry points past 1.1, see gl_functions.h.
+
+#include <stdio.h>
+
+#include "gl_functions.h"
+
+GLFunctions glf;
+
+#define LOAD_GL(name) (glf.name = (decltype(glf.name)) getProcAddress("gl" #name))
+
+int loadGLFunctions(GLGetProcAddress getProcAddress){
+    glf.major = 1;
+    glf.minor = 0;
+    const char* version = (const char*) glGetString(GL_VERSION);
+    if (version == NULL || sscanf(version, "%d.%d", &glf.major, &glf.minor) != 2) {
+        glf.loaded = 0;
+        glf.bufferStorage = 0;
+        return 0;
+    }
+
+    int found = 1;
+    found &= LOAD_GL(CreateShader) != NULL;
+    found &= LOAD_GL(ShaderSource) != NULL;
+    found &= LOAD_GL(CompileShader) != NULL;
+    found &= LOAD_GL(GetShaderiv) != NULL;
+    found &= LOAD_GL(GetShaderInfoLog) != NULL;
+    found &= LOAD_GL(DeleteShader) != NULL;
+    found &= LOAD_GL(CreateProgram) != NULL;
+    found &= LOAD_GL(AttachShader) != NULL;
+    found &= LOAD_GL(LinkProgram) != NULL;
+    found &= LOAD_GL(GetProgramiv) != NULL;
+    found &= LOAD_GL(GetProgramInfoLog) != NULL;
+    found &= LOAD_GL(DeleteProgram) != NULL;
+    found &= LOAD_GL(UseProgram) != NULL;
+    found &= LOAD_GL(GetUniformLocation) != NULL;
+    found &= LOAD_GL(Uniform2f) != NULL;
+    found &= LOAD_GL(Uniform1i) != NULL;
+    found &= LOAD_GL(GenBuffers) != NULL;
+    found &= LOAD_GL(DeleteBuffers) != NULL;
+    found &= LOAD_GL(BindBuffer) != NULL;
+    found &= LOAD_GL(BufferData) != NULL;
+    found &= LOAD_GL(BufferSubData) != NULL;
+    found &= LOAD_GL(GenVertexArrays) != NULL;
+    found &= LOAD_GL(DeleteVertexArrays) != NULL;
+    found &= LOAD_GL(BindVertexArray) != NULL;
+    found &= LOAD_GL(EnableVertexAttribArray) != NULL;
+    found &= LOAD_GL(VertexAttribPointer) != NULL;
+    found &= LOAD_GL(VertexAttribDivisor) != NULL;
+    found &= LOAD_GL(DrawArraysInstanced) != NULL;
+    found &= LOAD_GL(ActiveTexture) != NULL;
+    glf.loaded = found && (glf.major > 3 || (glf.major == 3 && glf.minor >= 3));
+
+    int storage = 1;
+    storage &= LOAD_GL(BufferStorage) != NULL;
+    storage &= LOAD_GL(MapBufferRange) != NULL;
+    storage &= LOAD_GL(UnmapBuffer) != NULL;
+    storage &= LOAD_GL(FenceSync) != NULL;
+    storage &= LOAD_GL(ClientWaitSync) != NULL;
+    storage &= LOAD_GL(DeleteSync) != NULL;
+    glf.bufferStorage = glf.loaded && storage && (glf.major > 4 || (glf.major == 4 && glf.minor >= 4));
+
+    return glf.loaded;
+}
+
+GLuint compileShader(GLenum type, const char* source){
+    GLuint shader = glf.CreateShader(type);
+    glf.ShaderSource(shader, 1, &source, NULL);
+    glf.CompileShader(shader);
+    GLint ok = 0;
+    glf.GetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        char log[1024];
+        glf.GetShaderInfoLog(shader, sizeof(log), NULL, log);
+        fprintf(stderr, "shader compile failed: %s\n", log);
+        glf.DeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+GLuint buildShaderProgram(const char* vertexSource, const char* fragmentSource){
+    GLuint vertex = compileShader(GL_VERTEX_SHADER, vertexSource);
+    GLuint fragment = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+    if (vertex == 0 || fragment == 0) {
+        if (vertex != 0) {
+            glf.DeleteShader(vertex);
+        }
+        if (fragment != 0) {
+            glf.DeleteShader(fragment);
+        }
+        return 0;
+    }
+
+    GLuint program = glf.CreateProgram();
+    glf.AttachShader(program, vertex);
+    glf.AttachShader(program, fragment);
+    glf.LinkProgram(program);
+    glf.DeleteShader(vertex);
+    glf.DeleteShader(fragment);
+
+    GLint ok = 0;
+    glf.GetProgramiv(program, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        char log[1024];
+        glf.GetProgramInfoLog(program, sizeof(log), NULL, log);
+        fprintf(stderr, "shader link failed: %s\n", log);
+        glf.DeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
@@ -0,0 +1,65 @@
+// OpenGL entry points past 1.1.
+// Only OpenGL 1.1 can be linked directly on every platform, everything newer has to be looked up at runtime.
+// The lookup function is passed in (glutGetProcAddress, eglGetProcAddress...) so the renderers don't depend on GLUT.
+
+#ifndef PONG_GL_FUNCTIONS_H
+#define PONG_GL_FUNCTIONS_H
+
+#include <GL/gl.h>
+#include <GL/glext.h>
+
+typedef void (*GLProc)(void);
+typedef GLProc (*GLGetProcAddress)(const char* name);
+
+typedef struct GLFunctions{
+    int major; //Context version
+    int minor;
+    int loaded; //1 when everything the 3.3 renderers need was found
+    int bufferStorage; //1 when BufferStorage/FenceSync are also there, for persistently mapped buffers
+
+    PFNGLCREATESHADERPROC CreateShader;
+    PFNGLSHADERSOURCEPROC ShaderSource;
+    PFNGLCOMPILESHADERPROC CompileShader;
+    PFNGLGETSHADERIVPROC GetShaderiv;
+    PFNGLGETSHADERINFOLOGPROC GetShaderInfoLog;
+    PFNGLDELETESHADERPROC DeleteShader;
+    PFNGLCREATEPROGRAMPROC CreateProgram;
+    PFNGLATTACHSHADERPROC AttachShader;
+    PFNGLLINKPROGRAMPROC LinkProgram;
+    PFNGLGETPROGRAMIVPROC GetProgramiv;
+    PFNGLGETPROGRAMINFOLOGPROC GetProgramInfoLog;
+    PFNGLDELETEPROGRAMPROC DeleteProgram;
+    PFNGLUSEPROGRAMPROC UseProgram;
+    PFNGLGETUNIFORMLOCATIONPROC GetUniformLocation;
+    PFNGLUNIFORM2FPROC Uniform2f;
+    PFNGLUNIFORM1IPROC Uniform1i;
+    PFNGLGENBUFFERSPROC GenBuffers;
+    PFNGLDELETEBUFFERSPROC DeleteBuffers;
+    PFNGLBINDBUFFERPROC BindBuffer;
+    PFNGLBUFFERDATAPROC BufferData;
+    PFNGLBUFFERSUBDATAPROC BufferSubData;
+    PFNGLGENVERTEXARRAYSPROC GenVertexArrays;
+    PFNGLDELETEVERTEXARRAYSPROC DeleteVertexArrays;
+    PFNGLBINDVERTEXARRAYPROC BindVertexArray;
+    PFNGLENABLEVERTEXATTRIBARRAYPROC EnableVertexAttribArray;
+    PFNGLVERTEXATTRIBPOINTERPROC VertexAttribPointer;
+    PFNGLVERTEXATTRIBDIVISORPROC VertexAttribDivisor;
+    PFNGLDRAWARRAYSINSTANCEDPROC DrawArraysInstanced;
+    PFNGLACTIVETEXTUREPROC ActiveTexture;
+
+    PFNGLBUFFERSTORAGEPROC BufferStorage;
+    PFNGLMAPBUFFERRANGEPROC MapBufferRange;
+    PFNGLUNMAPBUFFERPROC UnmapBuffer;
+    PFNGLFENCESYNCPROC FenceSync;
+    PFNGLCLIENTWAITSYNCPROC ClientWaitSync;
+    PFNGLDELETESYNCPROC DeleteSync;
+} GLFunctions;
+extern GLFunctions glf;
+
+//Looks up every entry point for the current context. Returns glf.loaded.
+int loadGLFunctions(GLGetProcAddress getProcAddress);
+
+//Compiles and links a vertex + fragment shader pair, printing the log on failure. Returns 0 on failure.
+GLuint buildShaderProgram(const char* vertexSource, const char* fragmentSource);
+
+#endif //PONG_GL_FUNCTIONS_H
@@ -0,0 +1,1248 @@
+// Headless match runner.
+// Plays full matches against the AI with the scripted player input, without a window or a GL context,
+// and reports simulation throughput. Intended for automated regression runs on machines with no display.
+
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "ai.h"
+#include "netplay.h"
+#include "batch_world.h"
+#include "event_sim.h"
+#include "fixed_physics.h"
+#include "game_config.h"
+#include "simulation_kernels.h"
+#include "chaos.h"
+#include "telemetry.h"
+#include "profiler.h"
+#include "replay.h"
+#include "scheduler.h"
+#include "simulation.h"
+#include "swept_collision.h"
+#include "tournament.h"
+#include "vector_env.h"
+
+typedef struct MatchResult{
+    long ticks;
+    long steps; //Times the simulation was stepped, fewer than ticks when ticks are skipped or batched
+    int playerScore;
+    int aiScore;
+} MatchResult;
+
+//Every match gets its own offset into the scripted input, so the matches of a run are not all identical
+long matchPhase(long match){
+    return match * 37;
+}
+
+//Match 0 of a run is recorded to this file when it is set
+const char* recordPath = NULL;
+
+int sameState(const Global* a, const Global* b){
+    return memcmp(a, b, sizeof(Global)) == 0;
+}
+
+//Reference for sweepBall() that moves the ball one unit at a time and tests for contact after every move,
+//written independently of the swept code on purpose
+long fineSweepBall(Global* state, long ticks){
+    SweptBox boxes[sweptBoxCount];
+    sweptBoxes(state, boxes);
+    int goalTop = goalPosition - (goalHeight / 2);
+    int goalBottom = goalPosition + (goalHeight / 2);
+
+    for (long tick = 0; tick < ticks; tick++) {
+        for (int unit = 0; unit < state->ballSpeed; unit++) {
+            int x1 = state->ballPosition.x;
+            int y1 = state->ballPosition.y;
+            int x2 = x1 + (state->ballDirection.x > 0) - (state->ballDirection.x < 0);
+            int y2 = y1 + (state->ballDirection.y > 0) - (state->ballDirection.y < 0);
+            state->ballPosition = (Point){x2, y2};
+
+            int flipX = 0;
+            int flipY = 0;
+            int goal = 0;
+            for (int i = 0; i < sweptBoxCount; i++) {
+                const SweptBox* box = &boxes[i];
+                int overlapX1 = x1 + ballSideLength >= box->x1 && x1 <= box->x2;
+                int overlapY1 = y1 + ballSideLength >= box->y1 && y1 <= box->y2;
+                int overlapX2 = x2 + ballSideLength >= box->x1 && x2 <= box->x2;
+                int overlapY2 = y2 + ballSideLength >= box->y1 && y2 <= box->y2;
+                if (!overlapX2 || !overlapY2 || (overlapX1 && overlapY1)) {
+                    continue;
+                }
+                if (box->kind != SWEPT_WALL && box->kind != SWEPT_PADDLE
+                    && y2 >= goalTop && y2 + ballSideLength <= goalBottom) {
+                    goal = box->kind;
+                }
+                flipX |= !overlapX1;
+                flipY |= !overlapY1;
+            }
+
+            if (goal) {
+                if (goal == SWEPT_LEFT_SIDE) {
+                    state->playerScore += 1;
+                    state->lastScore = 1;
+                } else {
+                    state->aiScore += 1;
+                    state->lastScore = 0;
+                }
+                portableResetBall(state);
+                if (state->playerScore >= winningScore || state->aiScore >= winningScore) {
+                    return tick + 1;
+                }
+                break;
+            }
+            if (flipX) {
+                state->ballDirection.x = -state->ballDirection.x;
+            }
+            if (flipY) {
+                state->ballDirection.y = -state->ballDirection.y;
+            }
+        }
+    }
+    return ticks;
+}
+
+//Sweeps a copy of state three ways: all ticks at once, one tick at a time, and one unit at a time.
+//Returns 1 if all three agree.
+int checkSweep(const Global* state, long ticks){
+    Global coarse = *state;
+    long coarseTicks = sweepBall(&coarse, ticks);
+
+    Global stepped = *state;
+    long steppedTicks = 0;
+    while (steppedTicks < ticks && stepped.playerScore < winningScore && stepped.aiScore < winningScore) {
+        steppedTicks += sweepBall(&stepped, 1);
+    }
+
+    Global fine = *state;
+    long fineTicks = fineSweepBall(&fine, ticks);
+
+    return coarseTicks == steppedTicks && coarseTicks == fineTicks
+           && sameState(&coarse, &stepped) && sameState(&coarse, &fine);
+}
+
+//Deterministic pseudo random numbers for the sweep checks
+unsigned int nextRandom(unsigned int* seed){
+    *seed = *seed * 1664525u + 1013904223u;
+    return *seed >> 8;
+}
+
+//Sweeps random states with random step lengths, including paddles in odd places and balls grazing corners.
+//Returns the number of states where the coarse, stepped and fine sweeps disagree.
+long checkRandomSweeps(long count){
+    unsigned int seed = 308;
+    long mismatches = 0;
+    for (long i = 0; i < count; i++) {
+        initGlobals();
+        Global state = global;
+        state.introScreen = 1;
+        state.ballPosition.x = wallThickness + (int) (nextRandom(&seed) % (screenWidth - 2 * wallThickness - ballSideLength));
+        state.ballPosition.y = wallThickness + (int) (nextRandom(&seed) % (screenHeight - 2 * wallThickness - ballSideLength));
+        state.ballDirection.x = nextRandom(&seed) % 2 ? 1 : -1;
+        state.ballDirection.y = nextRandom(&seed) % 2 ? 1 : -1;
+        state.ballSpeed = 1 + (int) (nextRandom(&seed) % 60);
+        state.playerPaddlePosition.y = (int) (nextRandom(&seed) % (screenHeight + paddleLength)) - paddleLength;
+        state.aiPaddlePosition.y = (int) (nextRandom(&seed) % (screenHeight + paddleLength)) - paddleLength;
+        state.playerScore = (int) (nextRandom(&seed) % winningScore);
+        state.aiScore = (int) (nextRandom(&seed) % winningScore);
+        state.lastScore = (int) (nextRandom(&seed) % 2);
+        long ticks = 1 + (long) (nextRandom(&seed) % 200);
+        if (!checkSweep(&state, ticks)) {
+            if (mismatches == 0) {
+                printf("sweep mismatch: random state %ld over %ld ticks\n", i, ticks);
+            }
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+//Plays one match from the initial state until someone reaches winningScore (or maxTicks runs out).
+//The AI is updateAI(), or the predictive AI at aiLevel when that isn't NULL. With swept set the ball uses sweepBall(), advancing step ticks at a time with the paddles sampled once per step,
+//and with verify set as well every step is checked with checkSweep().
+MatchResult runMatch(long match, long maxTicks, int swept, long step, int verify, long* mismatches,
+                     const AiParams* aiLevel){
+    initGlobals();
+    global.introScreen = 1;
+    AiState ai;
+    initAi(&ai, aiLevel, (unsigned int) match);
+    ReplayRecorder recorder;
+    int recording = recordPath && match == 0 && !swept;
+    if (recording && startRecording(&recorder, recordPath, 0, aiLevel ? &ai : NULL) != 0) {
+        printf("can't write %s\n", recordPath);
+        recording = 0;
+    }
+
+    long tick = 0;
+    long steps = 0;
+    while (global.gameOver == 0 && tick < maxTicks) {
+        steps++;
+        mouse(0, scriptedPlayerY(tick + matchPhase(match)));
+        if (recording) {
+            recordTick(&recorder, aiLevel ? &ai : NULL);
+        }
+        if (!swept && aiLevel) {
+            gameLogicWithAI(&ai);
+            tick++;
+            continue;
+        }
+        if (!swept) {
+            gameLogic();
+            tick++;
+            continue;
+        }
+
+        long ticks = step < maxTicks - tick ? step : maxTicks - tick;
+        if (verify && !checkSweep(&global, ticks)) {
+            if (*mismatches == 0) {
+                printf("sweep mismatch: match %ld at tick %ld\n", match, tick);
+            }
+            (*mismatches)++;
+        }
+        long ran = sweepBall(&global, ticks);
+        for (long i = 0; i < ran; i++) {
+            if (aiLevel) {
+                updatePredictiveAI(&global, &ai);
+            } else {
+                updateAI();
+            }
+        }
+        if (global.playerScore >= winningScore || global.aiScore >= winningScore) {
+            global.gameOver = 1;
+        }
+        tick += ran;
+    }
+    if (recording && finishRecording(&recorder) != 0) {
+        printf("can't write %s\n", recordPath);
+    }
+    return (MatchResult){tick, steps, global.playerScore, global.aiScore};
+}
+
+//Plays one match like runMatch(), skipping from event to event with quietTicks(). With verify set, a second copy
+//of the match is played tick by tick alongside and compared after every step. Returns the number of mismatches
+//in *mismatches.
+MatchResult runEventMatch(long match, long maxTicks, int verify, long* mismatches){
+    initGlobals();
+    global.introScreen = 1;
+    Global reference = global;
+
+    long tick = 0;
+    long steps = 0;
+    while (global.gameOver == 0 && tick < maxTicks) {
+        steps++;
+        long ticks = quietTicks(&global, maxTicks - tick);
+        if (ticks > 0) {
+            advanceQuietTicks(&global, ticks);
+            mouse(0, scriptedPlayerY(tick + ticks - 1 + matchPhase(match)));
+        } else {
+            ticks = 1;
+            mouse(0, scriptedPlayerY(tick + matchPhase(match)));
+            gameLogic();
+        }
+
+        if (verify) {
+            Global skipped = global;
+            global = reference;
+            for (long t = tick; t < tick + ticks; t++) {
+                mouse(0, scriptedPlayerY(t + matchPhase(match)));
+                gameLogic();
+            }
+            reference = global;
+            global = skipped;
+            if (!sameState(&global, &reference)) {
+                if (*mismatches == 0) {
+                    printf("event mismatch: match %ld at tick %ld\n", match, tick);
+                }
+                (*mismatches)++;
+                global = reference;
+            }
+        }
+        tick += ticks;
+    }
+    return (MatchResult){tick, steps, global.playerScore, global.aiScore};
+}
+
+//Plays all matches at once in a BatchWorld. With verify set, every lane is also stepped through the scalar
+//mouse()/gameLogic() path and compared after each tick. Returns the number of mismatching ticks.
+long runBatch(long matches, long maxTicks, int verify, MatchResult* results){
+    BatchWorld world;
+    initBatchWorld(&world, (int) matches);
+    int* mouseY = (int*) malloc(sizeof(int) * matches);
+    Global* reference = NULL;
+    if (verify) {
+        reference = (Global*) malloc(sizeof(Global) * matches);
+        for (long m = 0; m < matches; m++) {
+            initGlobals();
+            global.introScreen = 1;
+            reference[m] = global;
+        }
+    }
+
+    long mismatches = 0;
+    int running = (int) matches;
+    for (long tick = 0; running > 0 && tick < maxTicks; tick++) {
+        for (long m = 0; m < matches; m++) {
+            mouseY[m] = scriptedPlayerY(tick + matchPhase(m));
+        }
+        running = stepBatchWorld(&world, mouseY);
+
+        if (verify) {
+            for (long m = 0; m < matches; m++) {
+                global = reference[m];
+                mouse(0, mouseY[m]);
+                gameLogic();
+                reference[m] = global;
+                Global lane;
+                storeBatchLane(&world, (int) m, &lane);
+                if (!sameState(&lane, &reference[m])) {
+                    if (mismatches == 0) {
+                        printf("batch mismatch: match %ld at tick %ld\n", m, tick);
+                    }
+                    mismatches++;
+                    loadBatchLane(&world, (int) m, &reference[m]);
+                }
+            }
+        }
+    }
+
+    for (long m = 0; m < matches; m++) {
+        results[m] = (MatchResult){world.ticks[m], world.ticks[m], world.playerScore[m], world.aiScore[m]};
+    }
+    free(reference);
+    free(mouseY);
+    freeBatchWorld(&world);
+    return mismatches;
+}
+
+//Plays a recorded session back to the end. With verify set, it then seeks to every 97th tick, in a scrambled
+//order, and checks the state against the one seen on the way through. Returns the number of mismatches,
+//or -1 if the file can't be read.
+long runReplay(const char* path, int verify, MatchResult* result){
+    ReplayReader reader;
+    if (openReplay(&reader, path) != 0) {
+        printf("can't read replay %s\n", path);
+        return -1;
+    }
+
+    const long stride = 97;
+    long samples = (long) (reader.header->tickCount / stride) + 1;
+    Global* expected = (Global*) malloc(sizeof(Global) * samples);
+    expected[0] = reader.state;
+    while (stepReplay(&reader)) {
+        if (reader.tick % stride == 0) {
+            expected[reader.tick / stride] = reader.state;
+        }
+    }
+    *result = (MatchResult){reader.tick, reader.tick, reader.state.playerScore, reader.state.aiScore};
+    printf("replay:        %ld ticks, %lld input bytes, %lld keyframes\n", reader.tick,
+           (long long) reader.header->inputSize, (long long) reader.header->keyframeCount);
+
+    long mismatches = 0;
+    if (verify) {
+        for (long i = 0; i < samples; i++) {
+            long sample = (i * 7919) % samples;
+            if (!seekReplay(&reader, sample * stride) || !sameState(&reader.state, &expected[sample])) {
+                if (mismatches == 0) {
+                    printf("replay mismatch: seeking to tick %ld\n", sample * stride);
+                }
+                mismatches++;
+            }
+        }
+    }
+    free(expected);
+    closeReplay(&reader);
+    return mismatches;
+}
+
+//Parses "name:speed:deadZone:reactionDelay:noise:predict", the name is left pointing into spec
+int parseVariant(char* spec, AiParams* params){
+    char* name = strtok(spec, ":");
+    int values[5];
+    for (int i = 0; i < 5; i++) {
+        char* value = strtok(NULL, ":");
+        if (!value) {
+            return 0;
+        }
+        values[i] = atoi(value);
+    }
+    *params = (AiParams){name, values[0], values[1], values[2], values[3], values[4]};
+    return name != NULL && params->speed > 0;
+}
+
+void printTournamentTable(const Tournament* tournament, const char* title, double (*value)(const TournamentCell*)){
+    printf("%s\n%-10s %9s", title, "", "scripted");
+    for (int v = 0; v < tournament->variantCount; v++) {
+        printf(" %9.9s", tournament->variants[v].name);
+    }
+    printf("\n");
+    for (int v = 0; v < tournament->variantCount; v++) {
+        printf("%-10.10s", tournament->variants[v].name);
+        for (int o = 0; o < tournament->opponentCount; o++) {
+            printf(" %9.2f", value(tournamentCell(tournament, v, o)));
+        }
+        printf("\n");
+    }
+}
+
+double winRate(const TournamentCell* cell){
+    return cell->matches > 0 ? (double) cell->wins / cell->matches : 0.0;
+}
+
+//Seconds of play per point at the default tick rate
+double rallySeconds(const TournamentCell* cell){
+    long points = cell->points + cell->pointsAgainst;
+    return points > 0 ? (double) cell->ticks / points / defaultTickRate : 0.0;
+}
+
+double pointsPerMinute(const TournamentCell* cell){
+    return cell->ticks > 0 ? cell->points * 60.0 * defaultTickRate / cell->ticks : 0.0;
+}
+
+//Plays every variant against the scripted player and every variant, prints the tables and returns the number of
+//pairings that came out differently on one thread, when verify is set
+long runTournamentMode(const AiParams* variants, int variantCount, long matches, long maxTicks, int threads,
+                       int verify){
+    Tournament tournament;
+    tournament.variants = variants;
+    tournament.variantCount = variantCount;
+    tournament.matchesPerPairing = matches;
+    tournament.maxTicks = maxTicks;
+    tournament.threads = threads;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    runTournament(&tournament);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    long totalMatches = 0;
+    long totalTicks = 0;
+    long unfinished = 0;
+    for (int v = 0; v < variantCount; v++) {
+        for (int o = 0; o < tournament.opponentCount; o++) {
+            const TournamentCell* cell = tournamentCell(&tournament, v, o);
+            totalMatches += cell->matches;
+            totalTicks += cell->ticks;
+            unfinished += cell->matches - cell->wins - cell->losses;
+        }
+    }
+    printTournamentTable(&tournament, "win rate of the row against the column:", winRate);
+    printTournamentTable(&tournament, "seconds per point:", rallySeconds);
+    printTournamentTable(&tournament, "points per minute scored by the row:", pointsPerMinute);
+    printf("matches:       %ld (%ld per pairing, %ld unfinished)\n", totalMatches, matches, unfinished);
+    printf("ticks:         %ld\n", totalTicks);
+    printf("threads:       %d (%ld steals)\n", tournament.pool.threads, tournament.pool.steals);
+    printf("elapsed:       %.3f s\n", seconds);
+    printf("ticks/second:  %.0f\n", seconds > 0 ? totalTicks / seconds : 0.0);
+    printf("matches/second: %.1f\n", seconds > 0 ? totalMatches / seconds : 0.0);
+
+    long mismatches = 0;
+    if (verify) {
+        //Matches only depend on their index, so a single thread has to come to exactly the same tables
+        Tournament reference = tournament;
+        reference.threads = 1;
+        runTournament(&reference);
+        long cells = (long) variantCount * tournament.opponentCount;
+        for (long i = 0; i < cells; i++) {
+            mismatches += memcmp(&reference.cells[i], &tournament.cells[i], sizeof(TournamentCell)) != 0;
+        }
+        freeTournament(&reference);
+        printf("verify:        %ld pairings differ from a single threaded run\n", mismatches);
+
+        //A variant against itself has to come out even, row and column alike. Points are close to independent
+        //coin flips then, so allow four standard deviations.
+        long uneven = 0;
+        for (int v = 0; v < variantCount; v++) {
+            const TournamentCell* cell = tournamentCell(&tournament, v, v + 1);
+            long points = cell->points + cell->pointsAgainst;
+            if (labs(cell->points - cell->pointsAgainst) > 4 * sqrt((double) points)) {
+                printf("self-play mismatch: %s scores %ld against %ld on itself\n", variants[v].name, cell->points,
+                       cell->pointsAgainst);
+                uneven++;
+            }
+        }
+        printf("self-play:     %ld variants uneven against themselves\n", uneven);
+        mismatches += uneven;
+    }
+    freeTournament(&tournament);
+    return mismatches;
+}
+
+//Steps games environments steps times with a policy that follows the ball on the observations. With verify set,
+//every game is also played through mouse()/gameLogic() and checked after each step. Returns the number of
+//mismatching steps.
+long runEnv(long games, long steps, long maxTicks, int verify){
+    VectorEnv env;
+    initVectorEnv(&env, (int) games, (int) (maxTicks < 0x7fffffff ? maxTicks : 0));
+    float* observations = (float*) malloc(sizeof(float) * envObservationSize * games);
+    float* rewards = (float*) malloc(sizeof(float) * games);
+    unsigned char* terminated = (unsigned char*) malloc(games);
+    unsigned char* truncated = (unsigned char*) malloc(games);
+    int* returns = (int*) malloc(sizeof(int) * games);
+    int* actions = (int*) malloc(sizeof(int) * games);
+    EnvStep step = {observations, rewards, terminated, truncated, returns};
+    Global* reference = NULL;
+    if (verify) {
+        reference = (Global*) malloc(sizeof(Global) * games);
+        initGlobals();
+        global.introScreen = 1;
+        for (long g = 0; g < games; g++) {
+            reference[g] = global;
+        }
+    }
+
+    resetVectorEnv(&env, observations);
+    long episodes = 0;
+    long truncations = 0;
+    long returnSum = 0;
+    long mismatches = 0;
+    double seconds = 0;
+    for (long s = 0; s < steps; s++) {
+        //Aim the paddle's center at the ball, off by an amount that changes with the game so rallies end
+        for (long g = 0; g < games; g++) {
+            const float* observation = observations + g * envObservationSize;
+            actions[g] = (int) (observation[1] * screenHeight) + ballSideLength / 2 + (int) (g % 7) * 40 - 120;
+        }
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        stepVectorEnv(&env, actions, &step);
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        for (long g = 0; g < games; g++) {
+            if (terminated[g] || truncated[g]) {
+                episodes++;
+                truncations += truncated[g];
+                returnSum += returns[g];
+            }
+        }
+        if (verify) {
+            for (long g = 0; g < games; g++) {
+                global = reference[g];
+                mouse(0, actions[g]);
+                gameLogic();
+                int reward = (global.playerScore - reference[g].playerScore) - (global.aiScore - reference[g].aiScore);
+                int ended = global.gameOver != 0;
+                reference[g] = global;
+                if (ended || (env.maxTicks > 0 && truncated[g])) {
+                    initGlobals();
+                    global.introScreen = 1;
+                    reference[g] = global;
+                }
+                Global lane;
+                storeBatchLane(&env.world, (int) g, &lane);
+                if (!sameState(&lane, &reference[g]) || rewards[g] != (float) reward || terminated[g] != ended) {
+                    if (mismatches == 0) {
+                        printf("env mismatch: game %ld at step %ld\n", g, s);
+                    }
+                    mismatches++;
+                    loadBatchLane(&env.world, (int) g, &reference[g]);
+                }
+            }
+        }
+    }
+
+    long envSteps = games * steps;
+    printf("games:         %ld x %ld steps\n", games, steps);
+    printf("episodes:      %ld (%ld truncated)\n", episodes, truncations);
+    printf("mean return:   %.2f\n", episodes > 0 ? (double) returnSum / episodes : 0.0);
+    printf("step time:     %.3f s\n", seconds);
+    printf("steps/second:  %.0f\n", seconds > 0 ? envSteps / seconds : 0.0);
+    if (verify) {
+        printf("verify:        %ld mismatching steps\n", mismatches);
+    }
+    free(reference);
+    free(actions);
+    free(returns);
+    free(truncated);
+    free(terminated);
+    free(rewards);
+    free(observations);
+    freeVectorEnv(&env);
+    return mismatches;
+}
+
+//A value near edge half the time and anywhere in [-range, range] otherwise, so the kernels see both their
+//branch boundaries and states no game reaches
+int randomAround(unsigned int* seed, int edge, int range){
+    if (nextRandom(seed) % 2) {
+        return edge + (int) (nextRandom(seed) % 9) - 4;
+    }
+    return (int) (nextRandom(seed) % (2 * range + 1)) - range;
+}
+
+//Runs the asm and the portable kernels, and updateBall() and portableUpdateBall(), from count random states and
+//compares the states they leave. Returns the number of mismatching calls.
+long runKernelCheck(long count){
+#ifndef PONG_HAS_ASM_KERNELS
+    printf("no asm kernels on this architecture, the game uses the portable ones\n");
+    return 0;
+#else
+    const char* names[] = {"resetBall", "updateAI", "mouse", "keyPressed", "updateBall"};
+    long mismatches[5] = {0, 0, 0, 0, 0};
+    unsigned int seed = 2308;
+    for (long i = 0; i < count; i++) {
+        Global start;
+        start.playerPaddlePosition = (Point){randomAround(&seed, initialPlayerPaddlePosition.x, 4 * screenWidth),
+                                             randomAround(&seed, 0, 4 * screenHeight)};
+        start.ballPosition.x = randomAround(&seed, (screenWidth >> 1) - ballSideLength, 4 * screenWidth);
+        start.ballPosition.y = randomAround(&seed, 0, 4 * screenHeight);
+        //Puts the AI paddle about a ball speed from where it would be still, on either side
+        int aiEdge = start.ballPosition.y + (ballSideLength >> 1) - (paddleLength >> 1)
+                     + (nextRandom(&seed) % 2 ? initialBallSpeed : -initialBallSpeed);
+        start.aiPaddlePosition = (Point){randomAround(&seed, paddleOffset, 4 * screenWidth),
+                                         randomAround(&seed, aiEdge, 4 * screenHeight)};
+        start.playerScore = randomAround(&seed, winningScore, 100);
+        start.aiScore = randomAround(&seed, winningScore, 100);
+        start.ballSpeed = randomAround(&seed, initialBallSpeed, 100);
+        start.ballDirection = (Point){randomAround(&seed, 0, 2), randomAround(&seed, 0, 2)};
+        start.lastScore = randomAround(&seed, 0, 2);
+        start.gameOver = randomAround(&seed, 0, 2);
+        start.introScreen = randomAround(&seed, 0, 2);
+        int y = randomAround(&seed, paddleLength >> 1, 4 * screenHeight);
+        unsigned char key = nextRandom(&seed) % 2 ? 'r' : (unsigned char) nextRandom(&seed);
+
+        for (int k = 0; k < 5; k++) {
+            Global portable = start;
+            global = start;
+            if (k == 0) {
+                asmResetBall();
+                portableResetBall(&portable);
+            } else if (k == 1) {
+                asmUpdateAI();
+                portableUpdateAI(&portable);
+            } else if (k == 2) {
+                asmMouse(0, y);
+                portableMouse(&portable, y);
+            } else if (k == 3) {
+                asmKeyPressed(key);
+                portableKeyPressed(&portable, key);
+            } else {
+                updateBall();
+                portableUpdateBall(&portable);
+            }
+            if (!sameState(&global, &portable)) {
+                if (mismatches[k] == 0) {
+                    printf("kernel mismatch: %s from random state %ld\n", names[k], i);
+                }
+                mismatches[k]++;
+            }
+        }
+    }
+    long total = 0;
+    printf("states:        %ld\n", count);
+    printf("game kernels:  %s\n", simulationKernels());
+    for (int k = 0; k < 5; k++) {
+        printf("%-14s %ld mismatching calls\n", names[k], mismatches[k]);
+        total += mismatches[k];
+    }
+    return total;
+#endif
+}
+
+//1 if two chaos worlds hold the same balls, obstacles, paddles and scores
+int sameChaosWorld(const ChaosWorld* a, const ChaosWorld* b){
+    size_t ballBytes = sizeof(int) * a->ballCount;
+    return a->ballCount == b->ballCount && a->obstacleCount == b->obstacleCount
+           && memcmp(a->ballX, b->ballX, ballBytes) == 0 && memcmp(a->ballY, b->ballY, ballBytes) == 0
+           && memcmp(a->ballDirectionX, b->ballDirectionX, ballBytes) == 0
+           && memcmp(a->ballDirectionY, b->ballDirectionY, ballBytes) == 0
+           && memcmp(a->ballSpeed, b->ballSpeed, ballBytes) == 0 && memcmp(a->lastScore, b->lastScore, ballBytes) == 0
+           && memcmp(a->obstacles, b->obstacles, sizeof(ChaosObstacle) * a->obstacleCount) == 0
+           && a->playerPaddleY == b->playerPaddleY && a->aiPaddleY == b->aiPaddleY
+           && a->playerScore == b->playerScore && a->aiScore == b->aiScore;
+}
+
+//Plays a match with one ball and no obstacles in a chaos world next to mouse()/gameLogic(), comparing every
+//tick. Returns the number of mismatching ticks.
+long checkChaosSingleBall(long maxTicks){
+    ChaosWorld world;
+    initChaosWorld(&world, 1, 0);
+    initGlobals();
+    global.introScreen = 1;
+    addChaosBall(&world, global.ballPosition, global.ballDirection, global.ballSpeed);
+    long mismatches = 0;
+    for (long tick = 0; global.gameOver == 0 && tick < maxTicks; tick++) {
+        int y = scriptedPlayerY(tick);
+        mouse(0, y);
+        gameLogic();
+        stepChaosWorld(&world, y);
+        Global state;
+        storeChaosBall(&world, &state);
+        state.gameOver = global.gameOver;
+        if (!sameState(&state, &global)) {
+            if (mismatches == 0) {
+                printf("chaos mismatch: single ball at tick %ld\n", tick);
+            }
+            mismatches++;
+            loadChaosBall(&world, &global);
+        }
+    }
+    freeChaosWorld(&world);
+    return mismatches;
+}
+
+//Steps balls balls and the standard obstacles for ticks ticks and prints the cost per tick. With verify set,
+//checks a match with one ball against mouse()/gameLogic() and every tick against testing every pair.
+long runChaos(int balls, long ticks, int verify){
+    ChaosWorld world;
+    ChaosWorld brute;
+    initChaosWorld(&world, balls, 16);
+    fillChaosWorld(&world, balls, 308);
+    long mismatches = 0;
+    if (verify) {
+        mismatches += checkChaosSingleBall(ticks);
+        initChaosWorld(&brute, balls, 16);
+        fillChaosWorld(&brute, balls, 308);
+        brute.bruteForce = 1;
+    }
+
+    long goals = 0;
+    long tests = 0;
+    double seconds = 0;
+    std::vector<double> tickSeconds(ticks);
+    for (long tick = 0; tick < ticks; tick++) {
+        int y = scriptedPlayerY(tick);
+        auto start = std::chrono::steady_clock::now();
+        goals += stepChaosWorld(&world, y);
+        tickSeconds[tick] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        seconds += tickSeconds[tick];
+        tests += world.pairTests;
+        if (verify) {
+            stepChaosWorld(&brute, y);
+            if (!sameChaosWorld(&world, &brute)) {
+                if (mismatches == 0) {
+                    printf("chaos mismatch: grid and every pair differ at tick %ld\n", tick);
+                }
+                mismatches++;
+            }
+        }
+    }
+
+    const double budget = 1.0 / 120;
+    std::sort(tickSeconds.begin(), tickSeconds.end());
+    double p99 = ticks > 0 ? tickSeconds[ticks * 99 / 100] : 0.0;
+    double slowest = ticks > 0 ? tickSeconds[ticks - 1] : 0.0;
+    printf("balls:         %d, %d obstacles\n", world.ballCount, world.obstacleCount);
+    printf("ticks:         %ld\n", ticks);
+    printf("goals:         %ld (player %d, ai %d)\n", goals, world.playerScore, world.aiScore);
+    printf("tests/tick:    %.0f (every pair would be %.0f)\n", ticks > 0 ? (double) tests / ticks : 0.0,
+           (double) balls * (balls + world.obstacleCount));
+    printf("tick time:     %.3f ms mean, %.3f ms p99, %.3f ms max\n", ticks > 0 ? seconds * 1e3 / ticks : 0.0,
+           p99 * 1e3, slowest * 1e3);
+    printf("120 Hz budget: %.1f%% mean, %.1f%% p99\n", ticks > 0 ? seconds / ticks / budget * 100 : 0.0,
+           p99 / budget * 100);
+    if (verify) {
+        printf("verify:        %ld mismatching ticks\n", mismatches);
+        freeChaosWorld(&brute);
+    }
+    freeChaosWorld(&world);
+    return mismatches;
+}
+
+//Plays matches matches back to back, pushing a telemetry record every tick, as fast as they run. The writer
+//can't keep up with that, so records are dropped. With verify set, the file is read back and every record in it
+//is checked against the one pushed for its tick. Returns the number of mismatches.
+long runTelemetry(const char* path, long matches, long maxTicks, int verify){
+    TelemetryLog log;
+    if (startTelemetry(&log, path) != 0) {
+        printf("can't write telemetry %s\n", path);
+        return 1;
+    }
+    std::vector<TelemetryRecord> pushed;
+    long tick = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (long m = 0; m < matches; m++) {
+        initGlobals();
+        global.introScreen = 1;
+        for (long t = 0; global.gameOver == 0 && t < maxTicks; t++) {
+            Global before = global;
+            mouse(0, scriptedPlayerY(t + matchPhase(m)));
+            gameLogic();
+            TelemetryRecord record;
+            makeTelemetryRecord(&record, tick++, &before, &global);
+            pushTelemetry(&log, &record);
+            if (verify) {
+                pushed.push_back(record);
+            }
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    int failed = finishTelemetry(&log) != 0;
+    printf("ticks:         %ld\n", tick);
+    printf("records:       %lld written, %ld dropped\n", (long long) log.header.recordCount, log.droppedRecords);
+    printf("push time:     %.1f ns/tick, with the simulation\n", tick > 0 ? seconds * 1e9 / tick : 0.0);
+    if (failed) {
+        printf("can't write telemetry %s\n", path);
+        return 1;
+    }
+    if (!verify) {
+        return 0;
+    }
+
+    long mismatches = 0;
+    TelemetryReader reader;
+    if (openTelemetry(&reader, path) != 0) {
+        printf("can't read telemetry %s back\n", path);
+        return 1;
+    }
+    std::vector<TelemetryRecord> records(telemetryBlockRecords);
+    long written = 0;
+    for (long b = 0; b < reader.header->blockCount; b++) {
+        int count = readTelemetryBlock(&reader, b, records.data());
+        if (count < 0) {
+            printf("telemetry mismatch: block %ld is damaged\n", b);
+            mismatches++;
+            continue;
+        }
+        for (int i = 0; i < count; i++) {
+            long recordTick = (long) records[i].tick;
+            if (recordTick < 0 || recordTick >= tick
+                || memcmp(&records[i], &pushed[recordTick], sizeof(TelemetryRecord)) != 0) {
+                if (mismatches == 0) {
+                    printf("telemetry mismatch: record %ld of block %ld\n", (long) i, b);
+                }
+                mismatches++;
+            }
+        }
+        written += count;
+    }
+    if (written + log.droppedRecords != tick) {
+        printf("telemetry mismatch: %ld records written and %ld dropped of %ld\n", written, log.droppedRecords, tick);
+        mismatches++;
+    }
+    closeTelemetry(&reader);
+    printf("verify:        %ld mismatching records\n", mismatches);
+    return mismatches;
+}
+
+//Scripted paddle (top edge) of one side of a loopback netplay match
+int32_t netplayInput(int side, long tick){
+    return scriptedPlayerY(tick + side * 7919) - paddleLength / 2;
+}
+
+//Plays one two player match of ticks ticks between two rollback sessions talking UDP over loopback. Each side
+//only reads its socket every latency frames and drops dropPercent of what it sends. Returns the number of
+//sessions that ended up different from a run that had every input up front, or -1 if the sockets can't be set up.
+long runNetplay(long ticks, int latency, int dropPercent){
+    NetPeer peers[2];
+    if (openNetPeer(&peers[0], 0) != 0 || openNetPeer(&peers[1], 0) != 0
+        || setNetRemote(&peers[0], "127.0.0.1", netPeerPort(&peers[1])) != 0
+        || setNetRemote(&peers[1], "127.0.0.1", netPeerPort(&peers[0])) != 0) {
+        printf("can't open loopback sockets\n");
+        return -1;
+    }
+    initGlobals();
+    global.introScreen = 1;
+    Global start = global;
+    RollbackSession sessions[2];
+    initRollback(&sessions[ROLLBACK_RIGHT], ROLLBACK_RIGHT, &start);
+    initRollback(&sessions[ROLLBACK_LEFT], ROLLBACK_LEFT, &start);
+
+    long frames = 0;
+    long stalls = 0;
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    //Run until both sides have played every tick with the other side's real input
+    while (sessions[0].confirmedTick < ticks || sessions[1].confirmedTick < ticks) {
+        for (int side = 0; side < 2; side++) {
+            RollbackSession* session = &sessions[side];
+            peers[side].dropPercent = dropPercent;
+            if ((frames + side) % latency == 0) {
+                receiveNetInputs(&peers[side], session);
+            }
+            if (session->tick < ticks) {
+                if (canAdvanceRollback(session)) {
+                    advanceRollback(session, netplayInput(side, session->tick));
+                } else {
+                    stalls++;
+                }
+            }
+            //Sent every frame, whether or not there is anything new, so acks keep flowing
+            sendNetInputs(&peers[side], session);
+        }
+        frames++;
+    }
+    for (int side = 0; side < 2; side++) {
+        settleRollback(&sessions[side]);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    Global reference = start;
+    for (long tick = 0; tick < ticks; tick++) {
+        stepTwoPlayer(&reference, netplayInput(ROLLBACK_RIGHT, tick), netplayInput(ROLLBACK_LEFT, tick));
+    }
+    long mismatches = 0;
+    for (int side = 0; side < 2; side++) {
+        const RollbackSession* session = &sessions[side];
+        mismatches += !sameState(&session->state, &reference);
+        printf("%-6s rollbacks %ld, resimulated %ld ticks (%.2f per rollback, at most %ld), packets %ld sent, "
+               "%ld dropped, %ld received\n", side == ROLLBACK_RIGHT ? "right:" : "left:", session->rollbacks,
+               session->resimulatedTicks,
+               session->rollbacks > 0 ? (double) session->resimulatedTicks / session->rollbacks : 0.0,
+               session->maxRollback, peers[side].packetsSent, peers[side].packetsDropped,
+               peers[side].packetsReceived);
+        closeNetPeer(&peers[side]);
+    }
+    printf("ticks:         %ld in %ld frames (%ld stalls waiting for the other side)\n", ticks, frames, stalls);
+    printf("score:         %d - %d\n", reference.aiScore, reference.playerScore);
+    printf("elapsed:       %.3f s\n", seconds);
+    printf("verify:        %ld sessions differ from the run with every input known\n", mismatches);
+    return mismatches;
+}
+
+//Plays matches against updateAI() with the fixed point ball, and folds the ball of every tick into a hash, so
+//builds can be compared bit for bit
+uint32_t runFixedMatches(long matches, long maxTicks, MatchResult* results){
+    uint32_t hash = 2166136261u;
+    for (long match = 0; match < matches; match++) {
+        initGlobals();
+        global.introScreen = 1;
+        FixedBall ball;
+        fixedBallFromGlobal(&ball, &global);
+        long tick = 0;
+        while (global.gameOver == 0 && tick < maxTicks) {
+            mouse(0, scriptedPlayerY(tick + matchPhase(match)));
+            gameLogicFixed(&ball);
+            const fixed fields[5] = {ball.x, ball.y, ball.vx, ball.vy, ball.speed};
+            for (int i = 0; i < 5; i++) {
+                hash = (hash ^ (uint32_t) fields[i]) * 16777619u;
+            }
+            tick++;
+        }
+        results[match] = (MatchResult){tick, tick, global.playerScore, global.aiScore};
+    }
+    return hash;
+}
+
+//Plays matches in an arena through the configured step functions. With verify set, every match is played
+//through the generic (runtime) instantiation as well, and in the standard arena through mouse()/gameLogic()
+//too, and the final states compared. Returns the number of matches that differ.
+long runArenaMatches(const GameConfig* config, long matches, long maxTicks, int verify, MatchResult* results,
+                     int* constant){
+    long mismatches = 0;
+    int standard = sameGameConfig(config, &arenas[0].config);
+    for (long m = 0; m < matches; m++) {
+        Global state;
+        long ticks = playConfiguredMatch(config, &state, matchPhase(m), maxTicks, constant);
+        results[m] = (MatchResult){ticks, ticks, state.playerScore, state.aiScore};
+        if (!verify) {
+            continue;
+        }
+        Global generic;
+        long genericTicks = playArenaMatch(RuntimeArena{config}, &generic, matchPhase(m), maxTicks);
+        int same = genericTicks == ticks && sameState(&generic, &state);
+        if (standard) {
+            initGlobals();
+            global.introScreen = 1;
+            long tick = 0;
+            while (global.gameOver == 0 && tick < maxTicks) {
+                mouse(0, scriptedPlayerY(tick + matchPhase(m)));
+                gameLogic();
+                tick++;
+            }
+            same = same && tick == ticks && sameState(&global, &state);
+        }
+        if (!same) {
+            if (mismatches == 0) {
+                printf("arena mismatch: match %ld\n", m);
+            }
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+void printUsage(const char* program){
+    printf("usage: %s [--matches N] [--max-ticks N] [--batch] [--events] [--swept] [--fixed] [--arena NAME|FILE] [--step N] [--ai LEVEL] [--record FILE] [--replay FILE] [--tournament] [--variant SPEC] [--threads N] [--env STEPS] [--netplay TICKS] [--latency N] [--kernels N] [--chaos BALLS] [--telemetry FILE] [--drop PERCENT] [--trace FILE] [--verify] [--verbose]\n", program);
+    printf("  --matches N     number of matches to play (default 100)\n");
+    printf("  --max-ticks N   give up on a match after N ticks (default 1000000)\n");
+    printf("  --batch         play all matches together in a SIMD BatchWorld\n");
+    printf("  --events        skip the ticks between events instead of running every tick\n");
+    printf("  --swept         use continuous collision for the ball\n");
+    printf("  --fixed         move the ball in fixed point, at any angle, and print a hash of every tick\n");
+    printf("  --arena NAME|FILE play in the built in arena NAME (standard, small, wide) or the one in FILE, through\n");
+    printf("                  the configurable step functions\n");
+    printf("  --step N        with --swept, simulate N ticks per step (default 1)\n");
+    printf("  --ai LEVEL      play against the predictive AI: easy, medium, hard or perfect\n");
+    printf("                  (not with --batch or --events, which use the original AI)\n");
+    printf("  --record FILE   record the first match to a replay file\n");
+    printf("  --replay FILE   play a replay file back instead of playing matches\n");
+    printf("  --tournament    play every AI variant against the scripted player and every variant, --matches\n");
+    printf("                  per pairing, on all cores, and print win rate, point length and points per minute\n");
+    printf("  --variant SPEC  add a variant name:speed:deadZone:reactionDelay:noise:predict to the tournament\n");
+    printf("                  (repeatable, the AI levels are used when none is given). reactionDelay only\n");
+    printf("                  applies with predict 1\n");
+    printf("  --threads N     tournament threads (default one per hardware thread)\n");
+    printf("  --env STEPS     step --matches games through the vectorized environment STEPS times, with a policy\n");
+    printf("                  that follows the ball, and print environment steps per second\n");
+    printf("  --netplay TICKS play a two player rollback match over UDP on loopback, and check both sides end up\n");
+    printf("                  where a run with every input known does\n");
+    printf("  --latency N     with --netplay, each side reads its socket every N frames (default 4)\n");
+    printf("  --drop PERCENT  with --netplay, drop this share of packets (default 10)\n");
+    printf("  --kernels N     run the asm and the portable simulation kernels from N random states, and check\n");
+    printf("                  they leave the same state, and updateBall() against portableUpdateBall() (x86-64 only)\n");
+    printf("  --chaos BALLS   step BALLS balls and a set of obstacles in one arena for --max-ticks ticks (default\n");
+    printf("                  1200 here), and print the time per tick\n");
+    printf("  --telemetry FILE play --matches matches and write a telemetry record of every tick to FILE\n");
+    printf("  --trace FILE    write a Chrome trace of the timed zones and print their p50/p99\n");
+    printf("                  (needs a build with -DPONG_ENABLE_PROFILING=ON)\n");
+    printf("  --verify        with --batch, check every tick against the scalar path. With --swept, check\n");
+    printf("                  every step and a set of random states against tick and unit stepping.\n");
+    printf("                  With --events, check every step against the tick loop.\n");
+    printf("                  With --replay, check seeking against playing straight through.\n");
+    printf("                  With --tournament, check the tables against a single threaded run, and that\n");
+    printf("                  every variant comes out even against itself.\n");
+    printf("                  With --env, check every step against mouse()/gameLogic().\n");
+    printf("                  With --chaos, check one ball against mouse()/gameLogic() and the grid\n");
+    printf("                  against testing every pair.\n");
+    printf("                  With --telemetry, read the file back and check it against the records.\n");
+    printf("                  With --arena, check the constant and generic step functions (and in the\n");
+    printf("                  standard arena, mouse()/gameLogic()) against each other\n");
+    printf("  --verbose       print the result of every match\n");
+}
+
+int main(int argc, char **argv)
+{
+    long matches = 100;
+    long maxTicks = 1000000;
+    int verbose = 0;
+    int batch = 0;
+    int verify = 0;
+    int swept = 0;
+    int events = 0;
+    int fixedBall = 0;
+    uint32_t fixedHash = 0;
+    const char* arenaName = NULL;
+    GameConfig arena;
+    int arenaConstant = 0;
+    long step = 1;
+    const AiParams* aiLevel = NULL;
+    const char* replayPath = NULL;
+    const char* tracePath = NULL;
+    int tournament = 0;
+    int threads = 0;
+    AiParams variants[64];
+    int variantCount = 0;
+    long envSteps = 0;
+    long netplayTicks = 0;
+    long kernelStates = 0;
+    int chaosBalls = 0;
+    const char* telemetryPath = NULL;
+    int maxTicksSet = 0;
+    int latency = 4;
+    int dropPercent = 10;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--matches") == 0 && i + 1 < argc) {
+            matches = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--max-ticks") == 0 && i + 1 < argc) {
+            maxTicks = atol(argv[++i]);
+            maxTicksSet = 1;
+        } else if (strcmp(argv[i], "--batch") == 0) {
+            batch = 1;
+        } else if (strcmp(argv[i], "--events") == 0) {
+            events = 1;
+        } else if (strcmp(argv[i], "--swept") == 0) {
+            swept = 1;
+        } else if (strcmp(argv[i], "--fixed") == 0) {
+            fixedBall = 1;
+        } else if (strcmp(argv[i], "--arena") == 0 && i + 1 < argc) {
+            arenaName = argv[++i];
+            const GameConfig* builtIn = findArena(arenaName);
+            if (builtIn) {
+                arena = *builtIn;
+            } else if (loadGameConfig(arenaName, &arena) != 0) {
+                printf("%s is neither a built in arena nor a playable arena file\n", arenaName);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--step") == 0 && i + 1 < argc) {
+            step = atol(argv[++i]);
+            if (step < 1) {
+                step = 1;
+            }
+        } else if (strcmp(argv[i], "--ai") == 0 && i + 1 < argc) {
+            aiLevel = findAiLevel(argv[++i]);
+            if (!aiLevel) {
+                printf("unknown AI level: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else if (strcmp(argv[i], "--tournament") == 0) {
+            tournament = 1;
+        } else if (strcmp(argv[i], "--variant") == 0 && i + 1 < argc && variantCount < 64) {
+            if (!parseVariant(argv[++i], &variants[variantCount++])) {
+                printf("bad variant, expected name:speed:deadZone:reactionDelay:noise:predict\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--env") == 0 && i + 1 < argc) {
+            envSteps = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--telemetry") == 0 && i + 1 < argc) {
+            telemetryPath = argv[++i];
+        } else if (strcmp(argv[i], "--chaos") == 0 && i + 1 < argc) {
+            chaosBalls = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--kernels") == 0 && i + 1 < argc) {
+            kernelStates = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--netplay") == 0 && i + 1 < argc) {
+            netplayTicks = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--latency") == 0 && i + 1 < argc) {
+            latency = atoi(argv[++i]);
+            latency = latency > 0 ? latency : 1;
+        } else if (strcmp(argv[i], "--drop") == 0 && i + 1 < argc) {
+            dropPercent = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--verify") == 0) {
+            verify = 1;
+        } else if (strcmp(argv[i], "--verbose") == 0) {
+            verbose = 1;
+        } else {
+            printUsage(argv[0]);
+            return strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+
+    if (aiLevel && (batch || events)) {
+        printf("--ai can't be combined with --batch or --events\n");
+        return 1;
+    }
+
+    if (tournament) {
+        if (variantCount == 0) {
+            for (int i = 0; i < aiLevelCount; i++) {
+                variants[variantCount++] = aiLevels[i];
+            }
+        }
+        return runTournamentMode(variants, variantCount, matches, maxTicks, threads, verify) != 0;
+    }
+    if (netplayTicks > 0) {
+        return runNetplay(netplayTicks, latency, dropPercent) != 0;
+    }
+    if (telemetryPath) {
+        return runTelemetry(telemetryPath, matches, maxTicks, verify) != 0;
+    }
+    if (chaosBalls > 0) {
+        return runChaos(chaosBalls, maxTicksSet ? maxTicks : 1200, verify) != 0;
+    }
+    if (kernelStates > 0) {
+        return runKernelCheck(kernelStates) != 0;
+    }
+    if (envSteps > 0) {
+        return runEnv(matches, envSteps, maxTicks, verify) != 0;
+    }
+
+    long totalTicks = 0;
+    long totalSteps = 0;
+    long playerPoints = 0;
+    long aiPoints = 0;
+    long playerWins = 0;
+    long aiWins = 0;
+    long unfinished = 0;
+
+    MatchResult* results = (MatchResult*) malloc(sizeof(MatchResult) * (matches > 0 ? matches : 1));
+    long mismatches = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (replayPath) {
+        matches = 1;
+        mismatches = runReplay(replayPath, verify, results);
+        if (mismatches < 0) {
+            return 1;
+        }
+    } else if (arenaName) {
+        mismatches = runArenaMatches(&arena, matches, maxTicks, verify, results, &arenaConstant);
+    } else if (fixedBall) {
+        fixedHash = runFixedMatches(matches, maxTicks, results);
+    } else if (batch) {
+        mismatches = runBatch(matches, maxTicks, verify, results);
+    } else if (events) {
+        for (long m = 0; m < matches; m++) {
+            results[m] = runEventMatch(m, maxTicks, verify, &mismatches);
+        }
+    } else {
+        for (long m = 0; m < matches; m++) {
+            results[m] = runMatch(m, maxTicks, swept, step, verify, &mismatches, aiLevel);
+        }
+        if (swept && verify) {
+            mismatches += checkRandomSweeps(100000);
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (long m = 0; m < matches; m++) {
+        MatchResult result = results[m];
+        totalTicks += result.ticks;
+        totalSteps += result.steps;
+        playerPoints += result.playerScore;
+        aiPoints += result.aiScore;
+        if (result.playerScore >= winningScore) {
+            playerWins++;
+        } else if (result.aiScore >= winningScore) {
+            aiWins++;
+        } else {
+            unfinished++;
+        }
+        if (verbose) {
+            printf("match %ld: player %d - ai %d in %ld ticks\n", m, result.playerScore, result.aiScore, result.ticks);
+        }
+    }
+    free(results);
+
+    printf("matches:       %ld (player %ld, ai %ld, unfinished %ld)\n", matches, playerWins, aiWins, unfinished);
+    printf("points:        player %ld, ai %ld\n", playerPoints, aiPoints);
+    printf("ticks:         %ld\n", totalTicks);
+    printf("steps:         %ld\n", totalSteps);
+    printf("elapsed:       %.3f s\n", seconds);
+    printf("ticks/second:  %.0f\n", seconds > 0 ? totalTicks / seconds : 0.0);
+    printf("matches/second: %.1f\n", seconds > 0 ? matches / seconds : 0.0);
+    if (fixedBall) {
+        printf("ball hash:     %08x\n", fixedHash);
+    }
+    if (arenaName) {
+        printf("arena:         %s, %dx%d (%s step functions)\n", arenaName, arena.width, arena.height,
+               arenaConstant ? "constant" : "generic");
+    }
+    if (batch) {
+        printf("batch kernel:  %s\n", batchWorldIsa());
+    }
+    if (aiLevel) {
+        printf("ai level:      %s\n", aiLevel->name);
+    }
+    if (swept) {
+        printf("swept step:    %ld ticks\n", step);
+    }
+    if (verify && batch) {
+        printf("verify:        %ld mismatching lane ticks\n", mismatches);
+    } else if (verify && replayPath) {
+        printf("verify:        %ld mismatching seeks\n", mismatches);
+    } else if (verify && events) {
+        printf("verify:        %ld mismatching event steps\n", mismatches);
+    } else if (verify && swept) {
+        printf("verify:        %ld mismatching sweeps\n", mismatches);
+    } else if (verify && arenaName) {
+        printf("verify:        %ld mismatching matches\n", mismatches);
+    }
+
+    if (tracePath) {
+        if (!profilingEnabled()) {
+            printf("--trace needs a build with -DPONG_ENABLE_PROFILING=ON\n");
+        } else if (writeChromeTrace(tracePath) != 0) {
+            printf("can't write trace %s\n", tracePath);
+        } else {
+            ProfileStat stats[profileMaxZones];
+            int count = profileStats(stats, profileMaxZones);
+            printf("%-18s %10s %10s %10s\n", "zone", "count", "p50 us", "p99 us");
+            for (int i = 0; i < count; i++) {
+                printf("%-18s %10ld %10.3f %10.3f\n", stats[i].name, stats[i].count, stats[i].p50, stats[i].p99);
+            }
+        }
+    }
+
+    if (mismatches != 0) {
+        return 3;
+    }
+    return unfinished == 0 ? 0 : 2;
+}
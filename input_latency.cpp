@@ -0,0 +1,70 @@
+// Input sampling and input latency measurement, see input_latency.h.
+
+#include <algorithm>
+#include <string.h>
+
+#include "input_latency.h"
+
+void queueMouseInput(InputSampler* sampler, int y){
+    sampler->latestY = y;
+    sampler->pending = 1;
+    sampler->events++;
+}
+
+int takeMouseInput(InputSampler* sampler, int* y){
+    if (!sampler->pending) {
+        return 0;
+    }
+    *y = sampler->latestY;
+    sampler->pending = 0;
+    sampler->taken++;
+    return 1;
+}
+
+void initLatencyProbe(LatencyProbe* probe){
+    memset(probe, 0, sizeof(LatencyProbe));
+}
+
+void probeInput(LatencyProbe* probe, double time){
+    if (probe->waitingSince == 0) {
+        probe->waitingSince = time;
+    }
+}
+
+void probeInputApplied(LatencyProbe* probe){
+    if (probe->waitingSince != 0 && probe->appliedSince == 0) {
+        probe->appliedSince = probe->waitingSince;
+    }
+    probe->waitingSince = 0;
+}
+
+void probeFrameDrawn(LatencyProbe* probe){
+    if (probe->appliedSince != 0 && probe->drawnSince == 0) {
+        probe->drawnSince = probe->appliedSince;
+    }
+    probe->appliedSince = 0;
+}
+
+void probeFrameShown(LatencyProbe* probe, double time){
+    if (probe->drawnSince == 0) {
+        return;
+    }
+    probe->samples[probe->count % latencyProbeSamples] = (float) ((time - probe->drawnSince) * 1000);
+    probe->count++;
+    probe->drawnSince = 0;
+}
+
+LatencyStats latencyStats(const LatencyProbe* probe){
+    LatencyStats stats = {probe->count, 0, 0, 0};
+    long kept = std::min(probe->count, (long) latencyProbeSamples);
+    if (kept == 0) {
+        return stats;
+    }
+    float sorted[latencyProbeSamples];
+    std::copy(probe->samples, probe->samples + kept, sorted);
+    std::sort(sorted, sorted + kept);
+    stats.p50 = sorted[kept / 2];
+    stats.p99 = sorted[std::min(kept - 1, kept * 99 / 100)];
+    stats.max = sorted[kept - 1];
+    return stats;
+}
@@ -0,0 +1,60 @@
+// Input sampling and input latency measurement.
+// Mouse motion is queued as it arrives instead of moving the paddle there and then. Each tick takes the newest
+// position once, right before it simulates, so any number of motion events between two ticks cost one paddle
+// update, and every tick sees the paddle where it was when the tick started. The newest position can also be
+// read without taking it, to draw the paddle there at the last moment before a frame is submitted (late latch).
+//
+// The latency probe follows input through to the screen: it notes when the oldest input not yet shown
+// arrived, when it got into the game (a tick or a late latch), and when the frame drawn after that was done.
+// The time from the input to that frame is one sample.
+
+#ifndef PONG_INPUT_LATENCY_H
+#define PONG_INPUT_LATENCY_H
+
+typedef struct InputSampler{
+    int latestY; //Newest mouse y
+    int pending; //1 if latestY arrived after the last takeMouseInput
+    long events; //Motion events queued
+    long taken; //Positions handed to ticks, events - taken were coalesced away
+} InputSampler;
+
+void queueMouseInput(InputSampler* sampler, int y);
+
+//Hands out the newest position if one arrived since the last call. Returns 0 if there was none.
+int takeMouseInput(InputSampler* sampler, int* y);
+
+const int latencyProbeSamples = 4096; //The most recent samples are kept
+
+typedef struct LatencyProbe{
+    double waitingSince; //Arrival of the oldest input not in the game yet, 0 if there is none
+    double appliedSince; //Same, for input in the game but not drawn yet
+    double drawnSince; //Same, for input in the frame being finished
+    float samples[latencyProbeSamples]; //Milliseconds, a ring
+    long count; //Samples taken so far
+} LatencyProbe;
+
+typedef struct LatencyStats{
+    long count;
+    double p50; //Milliseconds
+    double p99;
+    double max;
+} LatencyStats;
+
+void initLatencyProbe(LatencyProbe* probe);
+
+//Input arrived at time (seconds on schedulerNow's clock)
+void probeInput(LatencyProbe* probe, double time);
+
+//Everything that arrived so far is in the game now
+void probeInputApplied(LatencyProbe* probe);
+
+//A frame is being drawn with everything applied so far
+void probeFrameDrawn(LatencyProbe* probe);
+
+//The frame drawn last is done, at time
+void probeFrameShown(LatencyProbe* probe, double time);
+
+//Percentiles of the samples still kept
+LatencyStats latencyStats(const LatencyProbe* probe);
+
+#endif //PONG_INPUT_LATENCY_H
@@ -0,0 +1,66 @@
+// Meshes for the intro screen, see intro_scene.h.
+// All triangles are counter clockwise seen from outside, so back face culling works like with the GLUT shapes.
+
+#include <math.h>
+
+#include "gl_functions.h"
+#include "intro_scene.h"
+
+void sphereVertex(float radius, float theta, float phi){
+    float nx = sinf(phi) * cosf(theta);
+    float ny = sinf(phi) * sinf(theta);
+    float nz = cosf(phi);
+    glNormal3f(nx, ny, nz);
+    glVertex3f(nx * radius, ny * radius, nz * radius);
+}
+
+void drawSolidSphere(float radius, int slices, int stacks){
+    const float pi = 3.14159265358979f;
+    glBegin(GL_TRIANGLES);
+    for (int i = 0; i < stacks; i++) {
+        //phi goes from the +z pole down to the -z pole
+        float phi1 = pi * i / stacks;
+        float phi2 = pi * (i + 1) / stacks;
+        for (int j = 0; j < slices; j++) {
+            float theta1 = 2 * pi * j / slices;
+            float theta2 = 2 * pi * (j + 1) / slices;
+            sphereVertex(radius, theta1, phi1);
+            sphereVertex(radius, theta1, phi2);
+            sphereVertex(radius, theta2, phi2);
+            sphereVertex(radius, theta1, phi1);
+            sphereVertex(radius, theta2, phi2);
+            sphereVertex(radius, theta2, phi1);
+        }
+    }
+    glEnd();
+}
+
+void drawSolidCube(float size){
+    //Each face is given by its normal n and two edge directions u, v with u x v = n
+    static const float faces[6][3][3] = {
+        {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}},
+        {{-1, 0, 0}, {0, 0, 1}, {0, 1, 0}},
+        {{0, 1, 0}, {0, 0, 1}, {1, 0, 0}},
+        {{0, -1, 0}, {1, 0, 0}, {0, 0, 1}},
+        {{0, 0, 1}, {1, 0, 0}, {0, 1, 0}},
+        {{0, 0, -1}, {0, 1, 0}, {1, 0, 0}},
+    };
+    static const float corners[4][2] = {{-1, -1}, {1, -1}, {1, 1}, {-1, 1}};
+    float half = size / 2;
+
+    glBegin(GL_QUADS);
+    for (int f = 0; f < 6; f++) {
+        const float* n = faces[f][0];
+        const float* u = faces[f][1];
+        const float* v = faces[f][2];
+        glNormal3f(n[0], n[1], n[2]);
+        for (int c = 0; c < 4; c++) {
+            float a = corners[c][0];
+            float b = corners[c][1];
+            glVertex3f((n[0] + a * u[0] + b * v[0]) * half,
+                       (n[1] + a * u[1] + b * v[1]) * half,
+                       (n[2] + a * u[2] + b * v[2]) * half);
+        }
+    }
+    glEnd();
+}
@@ -0,0 +1,14 @@
+// Meshes for the intro screen.
+// Same shapes glutSolidSphere and glutSolidCube draw, but tessellated by us so they can be compiled into a
+// display list once and replayed, and so the intro can be drawn in a context GLUT didn't create.
+
+#ifndef PONG_INTRO_SCENE_H
+#define PONG_INTRO_SCENE_H
+
+//Sphere centered on the origin, slices around the z axis and stacks along it, with outward normals
+void drawSolidSphere(float radius, int slices, int stacks);
+
+//Cube centered on the origin with the given side length, one normal per face
+void drawSolidCube(float size);
+
+#endif //PONG_INTRO_SCENE_H
@@ -0,0 +1,119 @@
+// UDP transport for rollback sessions, see netplay.h.
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "netplay.h"
+
+int openNetPeer(NetPeer* peer, int port){
+    memset(peer, 0, sizeof(NetPeer));
+    peer->seed = 1;
+    peer->socket = socket(AF_INET, SOCK_DGRAM, 0);
+    if (peer->socket < 0) {
+        return -1;
+    }
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons((uint16_t) port);
+    if (bind(peer->socket, (struct sockaddr*) &address, sizeof(address)) != 0
+        || fcntl(peer->socket, F_SETFL, fcntl(peer->socket, F_GETFL) | O_NONBLOCK) != 0) {
+        close(peer->socket);
+        peer->socket = -1;
+        return -1;
+    }
+    return 0;
+}
+
+void closeNetPeer(NetPeer* peer){
+    if (peer->socket >= 0) {
+        close(peer->socket);
+    }
+    peer->socket = -1;
+}
+
+int netPeerPort(const NetPeer* peer){
+    struct sockaddr_in address;
+    socklen_t length = sizeof(address);
+    if (getsockname(peer->socket, (struct sockaddr*) &address, &length) != 0) {
+        return -1;
+    }
+    return ntohs(address.sin_port);
+}
+
+int setNetRemote(NetPeer* peer, const char* host, int port){
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    struct addrinfo* found = NULL;
+    if (getaddrinfo(host, NULL, &hints, &found) != 0 || !found) {
+        return -1;
+    }
+    memcpy(&peer->remote, found->ai_addr, sizeof(peer->remote));
+    peer->remote.sin_port = htons((uint16_t) port);
+    peer->hasRemote = 1;
+    freeaddrinfo(found);
+    return 0;
+}
+
+void sendNetInputs(NetPeer* peer, const RollbackSession* session){
+    if (!peer->hasRemote) {
+        return;
+    }
+    NetPacket packet;
+    packet.magic = netplayMagic;
+    packet.ack = session->confirmedTick;
+    packet.firstTick = session->remoteAckTick;
+    packet.count = (int32_t) (session->tick - session->remoteAckTick);
+    for (int i = 0; i < packet.count; i++) {
+        packet.paddleY[i] = session->localInput[(packet.firstTick + i) & (rollbackInputs - 1)];
+    }
+
+    if (peer->dropPercent > 0) {
+        peer->seed = peer->seed * 1664525u + 1013904223u;
+        if ((int) ((peer->seed >> 8) % 100) < peer->dropPercent) {
+            peer->packetsDropped++;
+            return;
+        }
+    }
+    //Only the inputs in use go out
+    size_t size = offsetof(NetPacket, paddleY) + sizeof(int32_t) * packet.count;
+    if (sendto(peer->socket, &packet, size, 0, (struct sockaddr*) &peer->remote, sizeof(peer->remote)) == (ssize_t) size) {
+        peer->packetsSent++;
+    }
+}
+
+int receiveNetInputs(NetPeer* peer, RollbackSession* session){
+    int received = 0;
+    while (true) {
+        NetPacket packet;
+        struct sockaddr_in from;
+        socklen_t fromLength = sizeof(from);
+        ssize_t size = recvfrom(peer->socket, &packet, sizeof(packet), 0, (struct sockaddr*) &from, &fromLength);
+        if (size < 0) {
+            return received;
+        }
+        if (size < (ssize_t) offsetof(NetPacket, paddleY) || packet.magic != netplayMagic || packet.count < 0
+            || packet.count > rollbackWindow
+            || size < (ssize_t) (offsetof(NetPacket, paddleY) + sizeof(int32_t) * packet.count)) {
+            continue;
+        }
+        if (!peer->hasRemote) {
+            peer->remote = from;
+            peer->hasRemote = 1;
+        }
+        received++;
+        peer->packetsReceived++;
+        acknowledgeRollback(session, (long) packet.ack);
+        for (int i = 0; i < packet.count; i++) {
+            addRemoteInput(session, (long) packet.firstTick + i, packet.paddleY[i]);
+        }
+    }
+}
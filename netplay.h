@@ -0,0 +1,53 @@
+// UDP transport for rollback sessions.
+// Every packet carries all of the local inputs the remote side hasn't acknowledged yet, plus how many of its
+// inputs we have, so a lost packet is made up for by the next one and nothing is ever resent on a timer. Sockets
+// are non-blocking: sending and receiving never wait, and receiving drains whatever has arrived.
+// The host binds a known port and learns where the other side is from the first packet that arrives; the side
+// that joins is given the host's address.
+
+#ifndef PONG_NETPLAY_H
+#define PONG_NETPLAY_H
+
+#include <netinet/in.h>
+#include <stdint.h>
+
+#include "rollback.h"
+
+const uint32_t netplayMagic = 0x4c504e50; //"PNPL"
+
+typedef struct NetPacket{
+    uint32_t magic;
+    int32_t count; //Inputs in paddleY
+    int64_t ack; //Ticks of the receiver's input the sender has
+    int64_t firstTick; //Tick of paddleY[0]
+    int32_t paddleY[rollbackWindow];
+} NetPacket;
+
+typedef struct NetPeer{
+    int socket;
+    struct sockaddr_in remote;
+    int hasRemote; //0 until the host hears from the other side
+    int dropPercent; //Share of outgoing packets to throw away, for testing on loopback
+    unsigned int seed;
+    long packetsSent;
+    long packetsDropped;
+    long packetsReceived;
+} NetPeer;
+
+//Opens a non-blocking UDP socket on port (0 for any free port). Returns 0 on success.
+int openNetPeer(NetPeer* peer, int port);
+void closeNetPeer(NetPeer* peer);
+
+//Port the socket ended up on
+int netPeerPort(const NetPeer* peer);
+
+//Sends to host:port from now on. Returns 0 on success.
+int setNetRemote(NetPeer* peer, const char* host, int port);
+
+//Sends the inputs session->remoteAckTick onwards and our ack of the remote's
+void sendNetInputs(NetPeer* peer, const RollbackSession* session);
+
+//Hands every packet that arrived to session. Returns the number of packets read.
+int receiveNetInputs(NetPeer* peer, RollbackSession* session);
+
+#endif //PONG_NETPLAY_H
@@ -0,0 +1,47 @@
+// Offscreen OpenGL context, see offscreen_context.h.
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <stdlib.h>
+
+#include "gl_functions.h"
+#include "offscreen_context.h"
+
+GLProc eglProc(const char* name){
+    return (GLProc) eglGetProcAddress(name);
+}
+
+int createOffscreenContext(int width, int height, int hardware){
+    if (!hardware) {
+        setenv("LIBGL_ALWAYS_SOFTWARE", "1", 1);
+    }
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+            (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+    EGLDisplay display = getPlatformDisplay
+                         ? getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL)
+                         : eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, NULL, NULL) || !eglBindAPI(EGL_OPENGL_API)) {
+        return -1;
+    }
+
+    EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_DEPTH_SIZE, 16, EGL_NONE
+    };
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0) {
+        return -1;
+    }
+    //No version asked for, so Mesa gives the newest compatibility profile: the game still uses fixed function
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, NULL);
+    EGLint surfaceAttributes[] = {EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE};
+    EGLSurface surface = eglCreatePbufferSurface(display, config, surfaceAttributes);
+    if (context == EGL_NO_CONTEXT || surface == EGL_NO_SURFACE
+        || !eglMakeCurrent(display, surface, surface, context)) {
+        return -1;
+    }
+    glViewport(0, 0, width, height);
+    loadGLFunctions(eglProc);
+    return 0;
+}
@@ -0,0 +1,12 @@
+// Offscreen OpenGL context.
+// Creates a context with no window through EGL on Mesa's surfaceless platform, rendering into a pbuffer, for the
+// tools that draw the game without a display (pong_bench, pong_capture). Mesa's software rasterizer is forced
+// unless hardware is set, so the tools give the same results on machines with and without a GPU.
+
+#ifndef PONG_OFFSCREEN_CONTEXT_H
+#define PONG_OFFSCREEN_CONTEXT_H
+
+//Makes a width x height context current and loads the GL functions for it. Returns 0 on success.
+int createOffscreenContext(int width, int height, int hardware);
+
+#endif //PONG_OFFSCREEN_CONTEXT_H
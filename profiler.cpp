@@ -0,0 +1,170 @@
+// Scoped frame timing, see profiler.h.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "profiler.h"
+
+typedef struct ProfileRing{
+    ProfileEvent events[profileRingSize];
+    std::atomic<uint64_t> written; //Events recorded so far, the newest is at (written - 1) % profileRingSize
+    std::atomic<uint64_t> claimed; //written, or written + 1 while an event is being recorded
+    int threadId;
+    int depth;
+} ProfileRing;
+
+//Every thread's ring, so the export can find them. Rings are never freed, so the intervals of threads that
+//have finished can still be exported.
+const int profileMaxThreads = 64;
+ProfileRing* profileRings[profileMaxThreads];
+int profileRingCount = 0;
+std::mutex profileRingsLock;
+
+thread_local ProfileRing* profileRing = NULL;
+
+int64_t profileNow(){
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+ProfileRing* threadRing(){
+    if (!profileRing) {
+        std::lock_guard<std::mutex> guard(profileRingsLock);
+        if (profileRingCount == profileMaxThreads) {
+            return NULL;
+        }
+        profileRing = new ProfileRing();
+        profileRing->written = 0;
+        profileRing->claimed = 0;
+        profileRing->threadId = profileRingCount;
+        profileRing->depth = 0;
+        profileRings[profileRingCount++] = profileRing;
+    }
+    return profileRing;
+}
+
+void profileRecord(const char* name, int64_t start, int64_t end, int depth){
+    ProfileRing* ring = threadRing();
+    if (!ring) {
+        return;
+    }
+    //claimed goes up before the slot is overwritten, so a reader can tell the event it read may have changed
+    uint64_t index = ring->written.load(std::memory_order_relaxed);
+    ring->claimed.store(index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    ring->events[index % profileRingSize] = (ProfileEvent){name, start, end - start, depth};
+    ring->written.store(index + 1, std::memory_order_release);
+}
+
+int profileEnter(){
+    ProfileRing* ring = threadRing();
+    return ring ? ring->depth++ : 0;
+}
+
+void profileLeave(){
+    ProfileRing* ring = threadRing();
+    if (ring) {
+        ring->depth--;
+    }
+}
+
+//Calls visit for every event still in the rings, oldest first per thread. The owning threads keep recording
+//meanwhile, so each event is copied and then skipped if its slot was claimed for a newer event in the meantime.
+template <typename Visit>
+void forEachEvent(Visit visit){
+    std::lock_guard<std::mutex> guard(profileRingsLock);
+    for (int r = 0; r < profileRingCount; r++) {
+        const ProfileRing* ring = profileRings[r];
+        uint64_t written = ring->written.load(std::memory_order_acquire);
+        uint64_t first = written > (uint64_t) profileRingSize ? written - profileRingSize : 0;
+        for (uint64_t i = first; i < written; i++) {
+            ProfileEvent event = ring->events[i % profileRingSize];
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (ring->claimed.load(std::memory_order_relaxed) > i + profileRingSize) {
+                continue;
+            }
+            visit(ring->threadId, event);
+        }
+    }
+}
+
+int writeChromeTrace(const char* path){
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        return -1;
+    }
+    int64_t origin = -1;
+    forEachEvent([&](int, const ProfileEvent& event){
+        if (origin < 0 || event.start < origin) {
+            origin = event.start;
+        }
+    });
+
+    //Complete events ("ph": "X"), times in microseconds
+    fprintf(file, "{\"traceEvents\":[\n");
+    int first = 1;
+    forEachEvent([&](int threadId, const ProfileEvent& event){
+        fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                first ? "" : ",\n", event.name, threadId, (event.start - origin) / 1000.0, event.duration / 1000.0);
+        first = 0;
+    });
+    fprintf(file, "\n],\"displayTimeUnit\":\"ns\"}\n");
+
+    int failed = ferror(file);
+    failed |= fclose(file);
+    return failed ? -1 : 0;
+}
+
+int profileStats(ProfileStat* stats, int maxStats){
+    const char* names[profileMaxZones];
+    std::vector<int64_t> durations[profileMaxZones];
+    int zoneCount = 0;
+    forEachEvent([&](int, const ProfileEvent& event){
+        int zone = 0;
+        while (zone < zoneCount && strcmp(names[zone], event.name) != 0) {
+            zone++;
+        }
+        if (zone == zoneCount) {
+            if (zoneCount == profileMaxZones) {
+                return;
+            }
+            names[zoneCount++] = event.name;
+        }
+        durations[zone].push_back(event.duration);
+    });
+
+    ProfileStat all[profileMaxZones];
+    for (int zone = 0; zone < zoneCount; zone++) {
+        std::vector<int64_t>& samples = durations[zone];
+        std::sort(samples.begin(), samples.end());
+        double total = 0;
+        for (size_t i = 0; i < samples.size(); i++) {
+            total += samples[i];
+        }
+        all[zone] = (ProfileStat){names[zone], (long) samples.size(),
+                                    samples[samples.size() / 2] / 1000.0,
+                                    samples[(samples.size() * 99) / 100] / 1000.0,
+                                    total / 1000.0};
+    }
+    std::sort(all, all + zoneCount, [](const ProfileStat& a, const ProfileStat& b){
+        return a.total > b.total;
+    });
+    int count = zoneCount < maxStats ? zoneCount : maxStats;
+    for (int i = 0; i < count; i++) {
+        stats[i] = all[i];
+    }
+    return count;
+}
+
+int profilingEnabled(){
+#ifdef PONG_ENABLE_PROFILING
+    return 1;
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,72 @@
+// Scoped frame timing.
+// PROFILE_SCOPE("name") times the rest of the enclosing block and records the interval in a ring buffer that
+// belongs to the calling thread, so recording never takes a lock. The recorded intervals can be written out as
+// a Chrome trace (load it in chrome://tracing or Perfetto) or summarized per zone as p50/p99 over the intervals
+// still in the rings, which makes the summary a rolling one.
+//
+// The timers only exist when the build defines PONG_ENABLE_PROFILING (cmake -DPONG_ENABLE_PROFILING=ON).
+// Otherwise PROFILE_SCOPE expands to nothing and the rest of the API finds no samples.
+
+#ifndef PONG_PROFILER_H
+#define PONG_PROFILER_H
+
+#include <stdint.h>
+
+const int profileRingSize = 1 << 16; //Intervals kept per thread
+const int profileMaxZones = 64; //Distinct zone names profileStats reports
+
+typedef struct ProfileEvent{
+    const char* name; //Zone name, a string literal
+    int64_t start; //Nanoseconds on a monotonic clock
+    int64_t duration;
+    int depth; //Number of zones open around this one on the same thread
+} ProfileEvent;
+
+typedef struct ProfileStat{
+    const char* name;
+    long count;
+    double p50; //Microseconds
+    double p99;
+    double total; //Microseconds, of all intervals counted
+} ProfileStat;
+
+//Nanoseconds on the clock the timers use
+int64_t profileNow();
+
+//Records one interval on the calling thread
+void profileRecord(const char* name, int64_t start, int64_t end, int depth);
+
+//Zone nesting depth of the calling thread, for profileRecord
+int profileEnter();
+void profileLeave();
+
+//Writes every interval still in the rings as a Chrome trace. Returns 0 on success.
+//Can be called while other threads record; intervals they overwrite while the rings are read are left out.
+int writeChromeTrace(const char* path);
+
+//Fills stats (up to maxStats entries) with one entry per zone, sorted by total time, and returns the count.
+//Safe while other threads record, like writeChromeTrace.
+int profileStats(ProfileStat* stats, int maxStats);
+
+//1 when the timers are compiled in
+int profilingEnabled();
+
+#ifdef PONG_ENABLE_PROFILING
+typedef struct ProfileScope{
+    const char* name;
+    int64_t start;
+    int depth;
+    explicit ProfileScope(const char* zone) : name(zone), start(profileNow()), depth(profileEnter()) {}
+    ~ProfileScope(){
+        profileLeave();
+        profileRecord(name, start, profileNow(), depth);
+    }
+} ProfileScope;
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name)
+#endif
+
+#endif //PONG_PROFILER_H
@@ -0,0 +1,313 @@
+// Batched rectangle renderer, see rect_renderer.h.
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rect_renderer.h"
+
+const char* rectVertexShader =
+    "#version 330 core\n"
+    "layout(location = 0) in vec4 rect;\n" //x, y, width, height in pixels
+    "layout(location = 1) in vec4 color;\n"
+    "uniform vec2 screenSize;\n"
+    "out vec4 vertexColor;\n"
+    "void main(){\n"
+    //Corners of a triangle strip: (0,0) (1,0) (0,1) (1,1)
+    "    vec2 corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1));\n"
+    "    vec2 pixel = rect.xy + corner * rect.zw;\n"
+    "    gl_Position = vec4(pixel.x * 2.0 / screenSize.x - 1.0, 1.0 - pixel.y * 2.0 / screenSize.y, 0.0, 1.0);\n"
+    "    vertexColor = color;\n"
+    "}\n";
+
+const char* rectFragmentShader =
+    "#version 330 core\n"
+    "in vec4 vertexColor;\n"
+    "out vec4 fragColor;\n"
+    "void main(){\n"
+    "    fragColor = vertexColor;\n"
+    "}\n";
+
+const GLbitfield persistentFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+int initRectRenderer(RectRenderer* renderer, int screenW, int screenH, int forceImmediate){
+    memset(renderer, 0, sizeof(RectRenderer));
+    renderer->screenW = (float) screenW;
+    renderer->screenH = (float) screenH;
+    renderer->mode = RECT_RENDERER_IMMEDIATE;
+
+    if (!forceImmediate && glf.loaded) {
+        renderer->program = buildShaderProgram(rectVertexShader, rectFragmentShader);
+    }
+    if (renderer->program == 0) {
+        renderer->instances = (RectInstance*) malloc(sizeof(RectInstance) * rectRegionCapacity);
+        return renderer->mode;
+    }
+
+    renderer->screenSizeLocation = glf.GetUniformLocation(renderer->program, "screenSize");
+    glf.GenVertexArrays(1, &renderer->vertexArray);
+    glf.GenBuffers(1, &renderer->buffer);
+    glf.BindBuffer(GL_ARRAY_BUFFER, renderer->buffer);
+
+    if (glf.bufferStorage) {
+        GLsizeiptr size = (GLsizeiptr) sizeof(RectInstance) * rectRegionCapacity * rectRegionCount;
+        glf.BufferStorage(GL_ARRAY_BUFFER, size, NULL, persistentFlags);
+        renderer->instances = (RectInstance*) glf.MapBufferRange(GL_ARRAY_BUFFER, 0, size, persistentFlags);
+        if (renderer->instances != NULL) {
+            renderer->mode = RECT_RENDERER_PERSISTENT;
+        } else {
+            //Buffer storage is immutable, start over with a fresh buffer for the streamed path
+            glf.BindBuffer(GL_ARRAY_BUFFER, 0);
+            glf.DeleteBuffers(1, &renderer->buffer);
+            glf.GenBuffers(1, &renderer->buffer);
+            glf.BindBuffer(GL_ARRAY_BUFFER, renderer->buffer);
+        }
+    }
+    if (renderer->mode != RECT_RENDERER_PERSISTENT) {
+        glf.BufferData(GL_ARRAY_BUFFER, sizeof(RectInstance) * rectRegionCapacity, NULL, GL_STREAM_DRAW);
+        renderer->instances = (RectInstance*) malloc(sizeof(RectInstance) * rectRegionCapacity);
+        renderer->mode = RECT_RENDERER_INSTANCED;
+    }
+    glf.BindBuffer(GL_ARRAY_BUFFER, 0);
+    return renderer->mode;
+}
+
+void destroyRectRenderer(RectRenderer* renderer){
+    if (renderer->mode == RECT_RENDERER_PERSISTENT) {
+        for (int i = 0; i < rectRegionCount; i++) {
+            if (renderer->fences[i] != NULL) {
+                glf.DeleteSync(renderer->fences[i]);
+            }
+        }
+        glf.BindBuffer(GL_ARRAY_BUFFER, renderer->buffer);
+        glf.UnmapBuffer(GL_ARRAY_BUFFER);
+        glf.BindBuffer(GL_ARRAY_BUFFER, 0);
+    } else {
+        free(renderer->instances);
+    }
+    if (renderer->mode != RECT_RENDERER_IMMEDIATE) {
+        glf.DeleteBuffers(1, &renderer->buffer);
+        glf.DeleteVertexArrays(1, &renderer->vertexArray);
+        glf.DeleteProgram(renderer->program);
+    }
+    memset(renderer, 0, sizeof(RectRenderer));
+}
+
+void waitForRegion(RectRenderer* renderer, int region){
+    GLsync fence = renderer->fences[region];
+    if (fence == NULL) {
+        return;
+    }
+    //The GPU is normally done with a region two frames later, so this rarely waits
+    while (glf.ClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {
+    }
+    glf.DeleteSync(fence);
+    renderer->fences[region] = NULL;
+}
+
+void nextRegion(RectRenderer* renderer){
+    //Called once everything written to the current region has been drawn
+    if (renderer->mode == RECT_RENDERER_PERSISTENT) {
+        if (renderer->count > 0) {
+            renderer->fences[renderer->region] = glf.FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            renderer->region = (renderer->region + 1) % rectRegionCount;
+            waitForRegion(renderer, renderer->region);
+        }
+    } else if (renderer->mode == RECT_RENDERER_INSTANCED && renderer->count > 0) {
+        //Orphan the old storage so the driver doesn't wait for draws still reading it
+        glf.BindBuffer(GL_ARRAY_BUFFER, renderer->buffer);
+        glf.BufferData(GL_ARRAY_BUFFER, sizeof(RectInstance) * rectRegionCapacity, NULL, GL_STREAM_DRAW);
+        glf.BindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    renderer->count = 0;
+    renderer->flushed = 0;
+}
+
+void beginRects(RectRenderer* renderer){
+    nextRegion(renderer);
+    renderer->drawCalls = 0;
+}
+
+void pushRect(RectRenderer* renderer, int x, int y, int width, int height, Color color){
+    if (renderer->count == rectRegionCapacity) {
+        flushRects(renderer);
+        nextRegion(renderer);
+    }
+
+    int index = renderer->count;
+    if (renderer->mode == RECT_RENDERER_PERSISTENT) {
+        index += renderer->region * rectRegionCapacity;
+    }
+    RectInstance* rect = &renderer->instances[index];
+    rect->x = (float) x;
+    rect->y = (float) y;
+    rect->width = (float) width;
+    rect->height = (float) height;
+    rect->r = color.r;
+    rect->g = color.g;
+    rect->b = color.b;
+    rect->a = 255;
+    renderer->count++;
+}
+
+void drawImmediate(const RectRenderer* renderer, const RectInstance* instances, int count){
+    //Same pixel to NDC transform as the vertex shader
+    float scaleX = 2.0f / renderer->screenW;
+    float scaleY = 2.0f / renderer->screenH;
+    glBegin(GL_TRIANGLES);
+    for (int i = 0; i < count; i++) {
+        const RectInstance* rect = &instances[i];
+        float x1 = rect->x * scaleX - 1.0f;
+        float y1 = 1.0f - rect->y * scaleY;
+        float x2 = (rect->x + rect->width) * scaleX - 1.0f;
+        float y2 = 1.0f - (rect->y + rect->height) * scaleY;
+        glColor4ub(rect->r, rect->g, rect->b, rect->a);
+        glVertex2f(x1, y1);
+        glVertex2f(x2, y1);
+        glVertex2f(x2, y2);
+        glVertex2f(x1, y1);
+        glVertex2f(x2, y2);
+        glVertex2f(x1, y2);
+    }
+    glEnd();
+}
+
+void bindInstanceAttributes(size_t offset){
+    //Instance layout of the buffer bound to GL_ARRAY_BUFFER, starting offset bytes in
+    glf.EnableVertexAttribArray(0);
+    glf.VertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(RectInstance), (const void*) (offset + offsetof(RectInstance, x)));
+    glf.VertexAttribDivisor(0, 1);
+    glf.EnableVertexAttribArray(1);
+    glf.VertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(RectInstance), (const void*) (offset + offsetof(RectInstance, r)));
+    glf.VertexAttribDivisor(1, 1);
+}
+
+void flushRects(RectRenderer* renderer){
+    int count = renderer->count - renderer->flushed;
+    if (count <= 0) {
+        return;
+    }
+    int first = renderer->flushed;
+    renderer->flushed = renderer->count;
+    renderer->drawCalls++;
+
+    if (renderer->mode == RECT_RENDERER_IMMEDIATE) {
+        drawImmediate(renderer, &renderer->instances[first], count);
+        return;
+    }
+
+    glf.BindBuffer(GL_ARRAY_BUFFER, renderer->buffer);
+    if (renderer->mode == RECT_RENDERER_PERSISTENT) {
+        first += renderer->region * rectRegionCapacity;
+    } else {
+        glf.BufferSubData(GL_ARRAY_BUFFER, sizeof(RectInstance) * first, sizeof(RectInstance) * count,
+                          &renderer->instances[first]);
+    }
+
+    glf.UseProgram(renderer->program);
+    glf.Uniform2f(renderer->screenSizeLocation, renderer->screenW, renderer->screenH);
+    glf.BindVertexArray(renderer->vertexArray);
+    bindInstanceAttributes(sizeof(RectInstance) * first);
+    glf.DrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, count);
+
+    //Leave the fixed function pipeline usable for the text and intro screen code
+    glf.BindVertexArray(0);
+    glf.UseProgram(0);
+    glf.BindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void initRectLayer(RectLayer* layer, int capacity){
+    memset(layer, 0, sizeof(RectLayer));
+    layer->instances = (RectInstance*) malloc(sizeof(RectInstance) * capacity);
+    layer->capacity = capacity;
+    layer->dirty = 1;
+}
+
+void destroyRectLayer(RectLayer* layer){
+    if (layer->buffer != 0) {
+        glf.DeleteBuffers(1, &layer->buffer);
+        glf.DeleteVertexArrays(1, &layer->vertexArray);
+    }
+    if (layer->displayList != 0) {
+        glDeleteLists(layer->displayList, 1);
+    }
+    free(layer->instances);
+    memset(layer, 0, sizeof(RectLayer));
+}
+
+void clearRectLayer(RectLayer* layer){
+    layer->count = 0;
+    layer->dirty = 1;
+}
+
+void addLayerRect(RectLayer* layer, int x, int y, int width, int height, Color color){
+    if (layer->count == layer->capacity) {
+        layer->capacity *= 2;
+        layer->instances = (RectInstance*) realloc(layer->instances, sizeof(RectInstance) * layer->capacity);
+    }
+    RectInstance* rect = &layer->instances[layer->count++];
+    rect->x = (float) x;
+    rect->y = (float) y;
+    rect->width = (float) width;
+    rect->height = (float) height;
+    rect->r = color.r;
+    rect->g = color.g;
+    rect->b = color.b;
+    rect->a = 255;
+    layer->dirty = 1;
+}
+
+void uploadRectLayer(const RectRenderer* renderer, RectLayer* layer){
+    if (renderer->mode == RECT_RENDERER_IMMEDIATE) {
+        if (layer->displayList == 0) {
+            layer->displayList = glGenLists(1);
+        }
+        glNewList(layer->displayList, GL_COMPILE);
+        drawImmediate(renderer, layer->instances, layer->count);
+        glEndList();
+    } else {
+        if (layer->buffer == 0) {
+            glf.GenVertexArrays(1, &layer->vertexArray);
+            glf.GenBuffers(1, &layer->buffer);
+        }
+        glf.BindVertexArray(layer->vertexArray);
+        glf.BindBuffer(GL_ARRAY_BUFFER, layer->buffer);
+        glf.BufferData(GL_ARRAY_BUFFER, sizeof(RectInstance) * layer->count, layer->instances, GL_STATIC_DRAW);
+        bindInstanceAttributes(0);
+        glf.BindVertexArray(0);
+        glf.BindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    layer->dirty = 0;
+}
+
+void drawRectLayer(RectRenderer* renderer, RectLayer* layer){
+    if (layer->dirty) {
+        uploadRectLayer(renderer, layer);
+    }
+    if (layer->count == 0) {
+        return;
+    }
+    renderer->drawCalls++;
+
+    if (renderer->mode == RECT_RENDERER_IMMEDIATE) {
+        glCallList(layer->displayList);
+        return;
+    }
+    glf.UseProgram(renderer->program);
+    glf.Uniform2f(renderer->screenSizeLocation, renderer->screenW, renderer->screenH);
+    glf.BindVertexArray(layer->vertexArray);
+    glf.DrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, layer->count);
+    glf.BindVertexArray(0);
+    glf.UseProgram(0);
+}
+
+const char* rectRendererModeName(int mode){
+    switch (mode) {
+        case RECT_RENDERER_PERSISTENT:
+            return "instanced, persistent buffer";
+        case RECT_RENDERER_INSTANCED:
+            return "instanced, streamed buffer";
+        default:
+            return "immediate";
+    }
+}
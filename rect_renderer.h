@@ -0,0 +1,88 @@
+// Batched rectangle renderer.
+// Every axis aligned rect of a frame is appended to one instance buffer (pixel position, size and color) and drawn
+// with a single instanced call. The vertex shader turns pixels into normalized device coordinates, so nothing is
+// converted on the CPU. On 4.4+ contexts the instance buffer is persistently mapped and split in regions that are
+// fenced and reused round robin; on 3.3 it is streamed with BufferSubData. Older contexts get an immediate mode
+// fallback that still submits all rects of a flush in one glBegin/glEnd.
+
+#ifndef PONG_RECT_RENDERER_H
+#define PONG_RECT_RENDERER_H
+
+#include "color.h"
+#include "gl_functions.h"
+
+enum RectRendererMode{
+    RECT_RENDERER_IMMEDIATE = 0,
+    RECT_RENDERER_INSTANCED = 1, //Instanced draw, instance buffer streamed with BufferSubData
+    RECT_RENDERER_PERSISTENT = 2 //Instanced draw, instance buffer persistently mapped
+};
+
+typedef struct RectInstance{
+    float x; //Pixels, top left corner
+    float y;
+    float width;
+    float height;
+    unsigned char r;
+    unsigned char g;
+    unsigned char b;
+    unsigned char a;
+} RectInstance;
+
+const int rectRegionCount = 3; //Frames that can be in flight on the persistently mapped buffer
+const int rectRegionCapacity = 1024; //Rects per region
+
+typedef struct RectRenderer{
+    int mode; //RectRendererMode
+    float screenW; //Size of the pixel space that is mapped onto the viewport
+    float screenH;
+    GLuint program;
+    GLint screenSizeLocation;
+    GLuint vertexArray;
+    GLuint buffer;
+    RectInstance* instances; //Mapped buffer in persistent mode, CPU staging array otherwise
+    GLsync fences[rectRegionCount];
+    int region; //Region the current frame writes to
+    int count; //Rects in the current region
+    int flushed; //Rects of the current region that have already been drawn
+    int drawCalls; //Draw calls issued since beginRects, for stats
+} RectRenderer;
+
+//Sets up the renderer for a pixel space of screenW x screenH. Picks the best mode the current context supports,
+//forceImmediate skips straight to the fallback. Returns the mode it picked.
+int initRectRenderer(RectRenderer* renderer, int screenW, int screenH, int forceImmediate);
+void destroyRectRenderer(RectRenderer* renderer);
+
+//Starts a new frame
+void beginRects(RectRenderer* renderer);
+
+//Queues a rect covering pixels [x, x + width) x [y, y + height)
+void pushRect(RectRenderer* renderer, int x, int y, int width, int height, Color color);
+
+//Draws every rect queued since the last flush. Call before drawing anything else on top, like text.
+void flushRects(RectRenderer* renderer);
+
+//A set of rects that rarely changes, kept on the GPU between frames (in a display list in immediate mode).
+//Drawing a layer is one draw call and uploads nothing unless the layer was changed since it was last drawn.
+typedef struct RectLayer{
+    RectInstance* instances; //CPU copy
+    int count;
+    int capacity;
+    int dirty; //1 when the CPU copy has changed since the last upload
+    GLuint vertexArray;
+    GLuint buffer;
+    GLuint displayList;
+} RectLayer;
+
+void initRectLayer(RectLayer* layer, int capacity);
+void destroyRectLayer(RectLayer* layer);
+
+//Empties the layer, to rebuild it
+void clearRectLayer(RectLayer* layer);
+void addLayerRect(RectLayer* layer, int x, int y, int width, int height, Color color);
+
+//Draws the layer with the renderer's pipeline, uploading it first if it changed
+void drawRectLayer(RectRenderer* renderer, RectLayer* layer);
+
+const char* rectRendererModeName(int mode);
+
+#endif //PONG_RECT_RENDERER_H
@@ -0,0 +1,299 @@
+// Deterministic replays, see replay.h.
+
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "replay.h"
+
+void writeVarint(FILE* file, uint64_t value){
+    //LEB128: 7 bits per byte, high bit set on every byte but the last
+    while (value >= 0x80) {
+        fputc((int) (value & 0x7f) | 0x80, file);
+        value >>= 7;
+    }
+    fputc((int) value, file);
+}
+
+//Reads a varint at *cursor, returns 0 if it runs past end
+int readVarint(const unsigned char* data, long end, long* cursor, uint64_t* value){
+    uint64_t result = 0;
+    int shift = 0;
+    while (*cursor < end && shift < 64) {
+        unsigned char byte = data[(*cursor)++];
+        result |= (uint64_t) (byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            *value = result;
+            return 1;
+        }
+        shift += 7;
+    }
+    return 0;
+}
+
+//Small deltas of either sign become small unsigned numbers: 0, -1, 1, -2, 2... -> 0, 1, 2, 3, 4...
+uint64_t zigzag(int64_t value){
+    return ((uint64_t) value << 1) ^ (uint64_t) (value >> 63);
+}
+
+int64_t unzigzag(uint64_t value){
+    return (int64_t) (value >> 1) ^ -(int64_t) (value & 1);
+}
+
+void addKeyframe(ReplayRecorder* recorder, const AiState* ai){
+    if (recorder->header.keyframeCount == recorder->keyframeCapacity) {
+        recorder->keyframeCapacity = recorder->keyframeCapacity ? recorder->keyframeCapacity * 2 : 64;
+        recorder->keyframes = (ReplayKeyframe*) realloc(recorder->keyframes,
+                                                        sizeof(ReplayKeyframe) * recorder->keyframeCapacity);
+    }
+    ReplayKeyframe* keyframe = &recorder->keyframes[recorder->header.keyframeCount++];
+    memset(keyframe, 0, sizeof(ReplayKeyframe));
+    keyframe->tick = recorder->header.tickCount;
+    keyframe->inputOffset = ftell(recorder->file) - recorder->header.inputOffset;
+    keyframe->paddleY = recorder->paddleY;
+    keyframe->state = global;
+    if (ai) {
+        keyframe->ai = *ai;
+    }
+    keyframe->ai.params = NULL;
+}
+
+int startRecording(ReplayRecorder* recorder, const char* path, int tickRate, const AiState* ai){
+    memset(recorder, 0, sizeof(ReplayRecorder));
+    recorder->file = fopen(path, "wb");
+    if (!recorder->file) {
+        return -1;
+    }
+
+    ReplayHeader* header = &recorder->header;
+    header->magic = replayMagic;
+    header->version = replayVersion;
+    header->globalSize = sizeof(Global);
+    header->aiStateSize = sizeof(AiState);
+    header->tickRate = tickRate;
+    header->aiLevel = ai ? (int32_t) (ai->params - aiLevels) : -1;
+    header->keyframeInterval = defaultKeyframeInterval;
+    header->inputOffset = sizeof(ReplayHeader);
+    //Written for real by finishRecording, this only reserves the space
+    fwrite(header, sizeof(ReplayHeader), 1, recorder->file);
+
+    recorder->paddleY = global.playerPaddlePosition.y;
+    addKeyframe(recorder, ai);
+    return 0;
+}
+
+void recordKey(ReplayRecorder* recorder, unsigned char key){
+    if (recorder->file && recorder->keyCount < replayMaxKeys) {
+        recorder->keys[recorder->keyCount++] = key;
+    }
+}
+
+void recordTick(ReplayRecorder* recorder, const AiState* ai){
+    if (!recorder->file) {
+        return;
+    }
+
+    //Key presses have already changed global, so a keyframe can only be taken at a tick without any, and moves
+    //to the next quiet tick otherwise
+    long nextKeyframe = recorder->header.keyframeCount * (long) recorder->header.keyframeInterval;
+    if (recorder->header.tickCount >= nextKeyframe && recorder->keyCount == 0) {
+        addKeyframe(recorder, ai);
+    }
+
+    int32_t paddleY = global.playerPaddlePosition.y;
+    uint64_t record = zigzag(paddleY - recorder->paddleY) << 1 | (recorder->keyCount > 0);
+    writeVarint(recorder->file, record);
+    if (recorder->keyCount > 0) {
+        fputc(recorder->keyCount, recorder->file);
+        fwrite(recorder->keys, 1, recorder->keyCount, recorder->file);
+    }
+    recorder->paddleY = paddleY;
+    recorder->keyCount = 0;
+    recorder->header.tickCount++;
+}
+
+int finishRecording(ReplayRecorder* recorder){
+    if (!recorder->file) {
+        return -1;
+    }
+
+    ReplayHeader* header = &recorder->header;
+    long end = ftell(recorder->file);
+    header->inputSize = end - header->inputOffset;
+    //Keep the table 8 byte aligned, so a mapped file can be used in place
+    while (end % 8 != 0) {
+        fputc(0, recorder->file);
+        end++;
+    }
+    header->keyframeOffset = end;
+    fwrite(recorder->keyframes, sizeof(ReplayKeyframe), (size_t) header->keyframeCount, recorder->file);
+    fseek(recorder->file, 0, SEEK_SET);
+    fwrite(header, sizeof(ReplayHeader), 1, recorder->file);
+
+    int failed = ferror(recorder->file);
+    failed |= fclose(recorder->file);
+    free(recorder->keyframes);
+    recorder->file = NULL;
+    recorder->keyframes = NULL;
+    return failed ? -1 : 0;
+}
+
+int loadReplayFile(ReplayReader* reader, const char* path){
+#ifdef _WIN32
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return -1;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    unsigned char* data = (unsigned char*) malloc(size > 0 ? size : 1);
+    size_t got = fread(data, 1, size, file);
+    fclose(file);
+    if (got != (size_t) size) {
+        free(data);
+        return -1;
+    }
+    reader->data = data;
+    reader->size = size;
+    reader->mapped = 0;
+    return 0;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t) sizeof(ReplayHeader)) {
+        close(fd);
+        return -1;
+    }
+    void* data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return -1;
+    }
+    reader->data = (const unsigned char*) data;
+    reader->size = info.st_size;
+    reader->mapped = 1;
+    return 0;
+#endif
+}
+
+void loadKeyframe(ReplayReader* reader, const ReplayKeyframe* keyframe){
+    reader->tick = keyframe->tick;
+    reader->cursor = keyframe->inputOffset;
+    reader->paddleY = keyframe->paddleY;
+    reader->state = keyframe->state;
+    reader->ai = keyframe->ai;
+    reader->ai.params = reader->header->aiLevel >= 0 ? &aiLevels[reader->header->aiLevel] : NULL;
+}
+
+int openReplay(ReplayReader* reader, const char* path){
+    memset(reader, 0, sizeof(ReplayReader));
+    if (loadReplayFile(reader, path) != 0) {
+        return -1;
+    }
+
+    const ReplayHeader* header = (const ReplayHeader*) reader->data;
+    int64_t size = (int64_t) reader->size;
+    int valid = reader->size >= sizeof(ReplayHeader)
+                && header->magic == replayMagic && header->version == replayVersion
+                && header->globalSize == sizeof(Global) && header->aiStateSize == sizeof(AiState)
+                && header->aiLevel >= -1 && header->aiLevel < aiLevelCount
+                && header->inputOffset >= (int64_t) sizeof(ReplayHeader) && header->inputSize >= 0
+                && header->inputOffset + header->inputSize <= size
+                && header->keyframeOffset % 8 == 0 && header->keyframeCount > 0
+                && header->keyframeOffset + header->keyframeCount * (int64_t) sizeof(ReplayKeyframe) <= size;
+    if (!valid) {
+        closeReplay(reader);
+        return -1;
+    }
+
+    reader->header = header;
+    reader->input = reader->data + header->inputOffset;
+    reader->keyframes = (const ReplayKeyframe*) (reader->data + header->keyframeOffset);
+    loadKeyframe(reader, &reader->keyframes[0]);
+    return 0;
+}
+
+void closeReplay(ReplayReader* reader){
+    if (!reader->data) {
+        return;
+    }
+#ifdef _WIN32
+    free((void*) reader->data);
+#else
+    if (reader->mapped) {
+        munmap((void*) reader->data, reader->size);
+    }
+#endif
+    reader->data = NULL;
+    reader->header = NULL;
+}
+
+int stepReplay(ReplayReader* reader){
+    const ReplayHeader* header = reader->header;
+    if (reader->tick >= header->tickCount) {
+        return 0;
+    }
+
+    uint64_t record;
+    if (!readVarint(reader->input, (long) header->inputSize, &reader->cursor, &record)) {
+        return 0;
+    }
+
+    //Replays the tick the same way the game loop ran it, on global
+    global = reader->state;
+    if (record & 1) {
+        int count = reader->cursor < header->inputSize ? reader->input[reader->cursor++] : 0;
+        for (int i = 0; i < count && reader->cursor < header->inputSize; i++) {
+            keyPressed(reader->input[reader->cursor++]);
+        }
+    }
+    reader->paddleY += (int32_t) unzigzag(record >> 1);
+    global.playerPaddlePosition.y = reader->paddleY;
+    if (reader->ai.params) {
+        gameLogicWithAI(&reader->ai);
+    } else {
+        gameLogic();
+    }
+    reader->state = global;
+    reader->tick++;
+    return 1;
+}
+
+int seekReplay(ReplayReader* reader, long tick){
+    const ReplayHeader* header = reader->header;
+    if (tick < 0 || tick > header->tickCount) {
+        return 0;
+    }
+
+    //Last keyframe at or before tick. Going forward from where playback already is can be cheaper.
+    long low = 0;
+    long high = (long) header->keyframeCount - 1;
+    while (low < high) {
+        long middle = (low + high + 1) / 2;
+        if (reader->keyframes[middle].tick <= tick) {
+            low = middle;
+        } else {
+            high = middle - 1;
+        }
+    }
+    const ReplayKeyframe* keyframe = &reader->keyframes[low];
+    if (!(reader->tick <= tick && reader->tick >= keyframe->tick)) {
+        loadKeyframe(reader, keyframe);
+    }
+    while (reader->tick < tick) {
+        if (!stepReplay(reader)) {
+            return 0;
+        }
+    }
+    global = reader->state;
+    return 1;
+}
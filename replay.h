@@ -0,0 +1,108 @@
+// Deterministic replays.
+// The simulation only depends on its inputs, so a session is recorded as the input of every tick: where the
+// player paddle was and which keys were pressed since the previous tick. Each tick is one varint record holding
+// the change in paddle y, so a tick where the mouse didn't move takes one byte. Every keyframeInterval ticks the
+// whole Global (and AI state) is stored as well, so playback can seek to any tick by loading the keyframe before
+// it and simulating forward from there.
+//
+// File layout, all little endian and fixed size apart from the input stream, so the file can be memory mapped
+// and used in place:
+//     ReplayHeader
+//     input stream, one record per tick
+//     ReplayKeyframe table, keyframeCount entries
+
+#ifndef PONG_REPLAY_H
+#define PONG_REPLAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "ai.h"
+#include "simulation.h"
+
+const uint32_t replayMagic = 0x4c505250; //"PRPL"
+const uint32_t replayVersion = 1;
+const int defaultKeyframeInterval = 600; //Ticks, 10 seconds at the default tick rate
+const int replayMaxKeys = 16; //Keys one tick can record, more are dropped
+
+typedef struct ReplayHeader{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t globalSize; //sizeof(Global) and sizeof(AiState) of the build that wrote the file, which has to match
+    uint32_t aiStateSize;
+    int32_t tickRate; //Ticks/Second the session was played at, for playback speed only
+    int32_t aiLevel; //Index into aiLevels, -1 for the original updateAI()
+    int32_t keyframeInterval;
+    int32_t reserved;
+    int64_t tickCount;
+    int64_t inputOffset; //File offset of the input stream
+    int64_t inputSize; //Bytes
+    int64_t keyframeOffset; //File offset of the keyframe table
+    int64_t keyframeCount;
+} ReplayHeader;
+
+typedef struct ReplayKeyframe{
+    int64_t tick; //Ticks played before this state
+    int64_t inputOffset; //Offset of the record of that tick in the input stream
+    int32_t paddleY; //Player paddle y the next record is a delta from
+    int32_t reserved;
+    Global state;
+    AiState ai; //params is not valid in the file, it is restored from the header's aiLevel
+} ReplayKeyframe;
+
+typedef struct ReplayRecorder{
+    FILE* file;
+    ReplayHeader header;
+    int32_t paddleY; //Paddle y of the last record
+    unsigned char keys[replayMaxKeys]; //Pressed since the last tick
+    int keyCount;
+    ReplayKeyframe* keyframes;
+    long keyframeCapacity;
+} ReplayRecorder;
+
+//Starts recording to path, from the current global (and ai, NULL for the original AI). Returns 0 on success.
+int startRecording(ReplayRecorder* recorder, const char* path, int tickRate, const AiState* ai);
+
+//Queues a key press, to be stored with the next tick
+void recordKey(ReplayRecorder* recorder, unsigned char key);
+
+//Stores the input of the tick about to run. Call right before gameLogic(), with the AI state it will use.
+void recordTick(ReplayRecorder* recorder, const AiState* ai);
+
+//Writes the keyframe table and header and closes the file. Returns 0 on success.
+int finishRecording(ReplayRecorder* recorder);
+
+typedef struct ReplayReader{
+    const unsigned char* data; //The whole file
+    size_t size;
+    int mapped; //1 if data is a memory mapping, 0 if it was read into memory
+    const ReplayHeader* header;
+    const unsigned char* input;
+    const ReplayKeyframe* keyframes;
+    //Playback position
+    long tick; //Ticks played so far
+    long cursor; //Offset of the next record in the input stream
+    int32_t paddleY;
+    Global state;
+    AiState ai;
+} ReplayReader;
+
+//Maps a replay file and checks its header. Returns 0 on success. Playback starts at tick 0.
+int openReplay(ReplayReader* reader, const char* path);
+void closeReplay(ReplayReader* reader);
+
+//Plays the next tick. Returns 0 at the end of the replay.
+int stepReplay(ReplayReader* reader);
+
+//Moves playback to the state after tick ticks, from the nearest keyframe before it. Returns 0 if tick is past
+//the end of the replay.
+int seekReplay(ReplayReader* reader, long tick);
+
+//LEB128 varints and zigzag coding, as used for the input stream. Also used by telemetry.
+void writeVarint(FILE* file, uint64_t value);
+int readVarint(const unsigned char* data, long end, long* cursor, uint64_t* value);
+uint64_t zigzag(int64_t value);
+int64_t unzigzag(uint64_t value);
+
+#endif //PONG_REPLAY_H
@@ -0,0 +1,100 @@
+// Rollback for two player matches, see rollback.h.
+
+#include "rollback.h"
+#include "simulation_kernels.h"
+
+void stepTwoPlayer(Global* state, int32_t rightPaddleY, int32_t leftPaddleY){
+    if (state->gameOver) {
+        return;
+    }
+    state->playerPaddlePosition.y = rightPaddleY;
+    state->aiPaddlePosition.y = leftPaddleY;
+    //updateBall(), on state
+    portableUpdateBall(state);
+    if (state->playerScore >= winningScore || state->aiScore >= winningScore) {
+        state->gameOver = 1;
+    }
+}
+
+void initRollback(RollbackSession* session, int localSide, const Global* state){
+    session->localSide = localSide;
+    session->tick = 0;
+    session->confirmedTick = 0;
+    session->remoteAckTick = 0;
+    session->rollbackFrom = -1;
+    session->predictedInput = localSide == ROLLBACK_RIGHT ? state->aiPaddlePosition.y
+                                                          : state->playerPaddlePosition.y;
+    session->state = *state;
+    session->rollbacks = 0;
+    session->resimulatedTicks = 0;
+    session->maxRollback = 0;
+}
+
+int canAdvanceRollback(const RollbackSession* session){
+    //Past this the snapshot a correction needs, or the input the remote side is still missing, would be gone
+    return session->tick - session->confirmedTick < rollbackWindow
+           && session->tick - session->remoteAckTick < rollbackWindow;
+}
+
+//Runs tick on session->state, with the remote input it has or the prediction
+void runRollbackTick(RollbackSession* session, long tick){
+    int slot = (int) (tick & (rollbackInputs - 1));
+    if (tick >= session->confirmedTick) {
+        session->remoteInput[slot] = session->predictedInput;
+    }
+    session->snapshots[tick & (rollbackWindow - 1)] = session->state;
+    int32_t local = session->localInput[slot];
+    int32_t remote = session->remoteInput[slot];
+    if (session->localSide == ROLLBACK_RIGHT) {
+        stepTwoPlayer(&session->state, local, remote);
+    } else {
+        stepTwoPlayer(&session->state, remote, local);
+    }
+}
+
+void settleRollback(RollbackSession* session){
+    if (session->rollbackFrom < 0) {
+        return;
+    }
+    long from = session->rollbackFrom;
+    session->state = session->snapshots[from & (rollbackWindow - 1)];
+    for (long tick = from; tick < session->tick; tick++) {
+        runRollbackTick(session, tick);
+    }
+    long count = session->tick - from;
+    session->rollbacks++;
+    session->resimulatedTicks += count;
+    session->maxRollback = count > session->maxRollback ? count : session->maxRollback;
+    session->rollbackFrom = -1;
+}
+
+void advanceRollback(RollbackSession* session, int32_t localPaddleY){
+    settleRollback(session);
+    session->localInput[session->tick & (rollbackInputs - 1)] = localPaddleY;
+    runRollbackTick(session, session->tick);
+    session->tick++;
+}
+
+void addRemoteInput(RollbackSession* session, long tick, int32_t paddleY){
+    //Only the next missing input, and only while its slot isn't holding one we still need
+    if (tick != session->confirmedTick || tick >= session->tick + rollbackWindow) {
+        return;
+    }
+    int slot = (int) (tick & (rollbackInputs - 1));
+    if (tick < session->tick && session->remoteInput[slot] != paddleY && session->rollbackFrom < 0) {
+        session->rollbackFrom = tick;
+    }
+    session->remoteInput[slot] = paddleY;
+    session->predictedInput = paddleY;
+    session->confirmedTick++;
+}
+
+const Global* rollbackStateBefore(const RollbackSession* session, long tick){
+    return tick == session->tick ? &session->state : &session->snapshots[tick & (rollbackWindow - 1)];
+}
+
+void acknowledgeRollback(RollbackSession* session, long tick){
+    if (tick > session->remoteAckTick && tick <= session->tick) {
+        session->remoteAckTick = tick;
+    }
+}
@@ -0,0 +1,69 @@
+// Rollback for two player matches over a network.
+// Each side plays one paddle: the right one (the player paddle of a local game) or the left one (where the AI
+// would be). A tick only depends on both paddle positions, so every tick runs straight away with the local input
+// and a prediction of the remote one (the last remote input that arrived). The state before every tick is kept in
+// a ring of snapshots. When a remote input arrives that differs from what was predicted for its tick, the state
+// goes back to the snapshot before that tick and the ticks since are simulated again with the real input.
+//
+// Everything is stored inline in the session: a snapshot is a copy of one Global, and taking, restoring and
+// resimulating never allocate. Nothing touches global, so any number of sessions can run in one process.
+// A side can get at most rollbackWindow ticks ahead of what it knows of the other side; past that it has to wait.
+
+#ifndef PONG_ROLLBACK_H
+#define PONG_ROLLBACK_H
+
+#include <stdint.h>
+
+#include "simulation.h"
+
+const int rollbackWindow = 16; //Ticks of snapshots, how far back a correction can reach. A power of two.
+const int rollbackInputs = 2 * rollbackWindow; //Inputs kept per side, the remote one can be a window ahead of us
+
+enum RollbackSide{
+    ROLLBACK_RIGHT = 0, //The player paddle
+    ROLLBACK_LEFT = 1 //The AI paddle
+};
+
+typedef struct RollbackSession{
+    int localSide; //RollbackSide
+    long tick; //Ticks simulated
+    long confirmedTick; //Remote input is known for every tick before this
+    long remoteAckTick; //The remote side has our input for every tick before this
+    long rollbackFrom; //Earliest tick that ran with a wrong prediction, -1 if none
+    int32_t predictedInput; //Last remote input that arrived, used for every tick after it
+    Global state;
+    Global snapshots[rollbackWindow]; //State before tick t at t % rollbackWindow
+    int32_t localInput[rollbackInputs]; //Paddle y (top edge) for tick t at t % rollbackInputs
+    int32_t remoteInput[rollbackInputs]; //Confirmed, or what was predicted for ticks past confirmedTick
+    //Statistics
+    long rollbacks;
+    long resimulatedTicks;
+    long maxRollback; //Most ticks resimulated at once
+} RollbackSession;
+
+//Starts a session at state, on localSide. Both sides have to start from the same state.
+void initRollback(RollbackSession* session, int localSide, const Global* state);
+
+//1 if the session can run another tick, 0 if it is a whole window ahead of the remote side and has to wait
+int canAdvanceRollback(const RollbackSession* session);
+
+//Corrects any misprediction, then runs the next tick with the local paddle at localPaddleY
+void advanceRollback(RollbackSession* session, int32_t localPaddleY);
+
+//Corrects any misprediction without running a tick, so state is up to date with every input that arrived
+void settleRollback(RollbackSession* session);
+
+//The remote input for tick. Inputs have to arrive in order; repeats and ones out of reach are ignored.
+void addRemoteInput(RollbackSession* session, long tick, int32_t paddleY);
+
+//The remote side has our input for every tick before tick
+void acknowledgeRollback(RollbackSession* session, long tick);
+
+//State before tick, for the last rollbackWindow ticks up to session->tick (which gives the current state).
+//Ticks past confirmedTick may still be corrected.
+const Global* rollbackStateBefore(const RollbackSession* session, long tick);
+
+//One tick of a two player match: both paddles are set, then the ball moves. Does nothing once the game is over.
+void stepTwoPlayer(Global* state, int32_t rightPaddleY, int32_t leftPaddleY);
+
+#endif //PONG_ROLLBACK_H
@@ -0,0 +1,85 @@
+// Fixed timestep scheduler, see scheduler.h.
+
+#include <chrono>
+#include <math.h>
+
+#include "scheduler.h"
+
+void initScheduler(Scheduler* scheduler, int tickRate, int maxSteps){
+    scheduler->tickSeconds = 1.0 / (tickRate > 0 ? tickRate : defaultTickRate);
+    scheduler->accumulator = 0;
+    scheduler->lastTime = 0;
+    scheduler->maxSteps = maxSteps > 0 ? maxSteps : 1;
+    scheduler->started = 0;
+    scheduler->ticks = 0;
+    scheduler->droppedTicks = 0;
+}
+
+void restartScheduler(Scheduler* scheduler){
+    scheduler->started = 0;
+    scheduler->accumulator = 0;
+}
+
+int pollScheduler(Scheduler* scheduler, double now){
+    if (!scheduler->started) {
+        scheduler->started = 1;
+        scheduler->lastTime = now;
+        return 0;
+    }
+
+    double elapsed = now - scheduler->lastTime;
+    scheduler->lastTime = now;
+    if (elapsed > 0) {
+        scheduler->accumulator += elapsed;
+    }
+
+    int steps = (int) (scheduler->accumulator / scheduler->tickSeconds);
+    if (steps > scheduler->maxSteps) {
+        //Too far behind to catch up, drop the backlog but keep the fraction of the tick we are into
+        scheduler->droppedTicks += steps - scheduler->maxSteps;
+        scheduler->accumulator -= (steps - scheduler->maxSteps) * scheduler->tickSeconds;
+        steps = scheduler->maxSteps;
+    }
+    scheduler->accumulator -= steps * scheduler->tickSeconds;
+    scheduler->ticks += steps;
+    return steps;
+}
+
+double schedulerNextTick(const Scheduler* scheduler){
+    if (!scheduler->started) {
+        return 0;
+    }
+    return scheduler->lastTime + (scheduler->tickSeconds - scheduler->accumulator);
+}
+
+float schedulerAlpha(const Scheduler* scheduler){
+    float alpha = (float) (scheduler->accumulator / scheduler->tickSeconds);
+    if (alpha < 0) {
+        return 0;
+    }
+    return alpha > 1 ? 1 : alpha;
+}
+
+double schedulerNow(){
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int lerpPixel(int from, int to, float alpha){
+    return from + (int) lroundf((float) (to - from) * alpha);
+}
+
+Point lerpPoint(Point from, Point to, float alpha){
+    return (Point){lerpPixel(from.x, to.x, alpha), lerpPixel(from.y, to.y, alpha)};
+}
+
+Global interpolateGlobal(const Global* previous, const Global* current, float alpha){
+    Global view = *current;
+    view.playerPaddlePosition = lerpPoint(previous->playerPaddlePosition, current->playerPaddlePosition, alpha);
+    view.aiPaddlePosition = lerpPoint(previous->aiPaddlePosition, current->aiPaddlePosition, alpha);
+
+    int scored = previous->playerScore != current->playerScore || previous->aiScore != current->aiScore;
+    if (!scored) {
+        view.ballPosition = lerpPoint(previous->ballPosition, current->ballPosition, alpha);
+    }
+    return view;
+}
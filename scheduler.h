@@ -0,0 +1,45 @@
+// Fixed timestep scheduler.
+// The simulation advances in ticks of a fixed length no matter how often the caller polls it. Elapsed wall time
+// is collected in an accumulator and paid out as whole ticks, with a cap on how many ticks one poll may run so a
+// long stall doesn't snowball. What is left over in the accumulator is the fraction of a tick to interpolate by.
+
+#ifndef PONG_SCHEDULER_H
+#define PONG_SCHEDULER_H
+
+#include "simulation.h"
+
+const int defaultTickRate = 60; //Ticks/Second
+const int defaultMaxStepsPerFrame = 5;
+
+typedef struct Scheduler{
+    double tickSeconds; //Length of one tick
+    double accumulator; //Wall time not yet simulated, in seconds
+    double lastTime; //Time of the previous poll, in seconds
+    int maxSteps; //Most ticks one poll may run before the rest of the backlog is dropped
+    int started; //0 until the first poll
+    long ticks; //Ticks run so far
+    long droppedTicks; //Ticks skipped because the backlog was over maxSteps
+} Scheduler;
+
+void initScheduler(Scheduler* scheduler, int tickRate, int maxSteps);
+
+//Forgets the time since the last poll, e.g. when the loop was stopped for a while and shouldn't catch up
+void restartScheduler(Scheduler* scheduler);
+
+//Adds the time since the last poll to the accumulator and returns how many ticks to run now
+int pollScheduler(Scheduler* scheduler, double now);
+
+//When the next tick is due, on schedulerNow's clock. Right away if the scheduler hasn't been polled yet.
+double schedulerNextTick(const Scheduler* scheduler);
+
+//How far between the last tick and the next one we are, from 0 to 1
+float schedulerAlpha(const Scheduler* scheduler);
+
+//Seconds on a monotonic clock
+double schedulerNow();
+
+//State to draw between two ticks. Ball and paddle positions are blended by alpha, everything else comes from
+//current. The ball is not blended across a goal, because resetBall teleports it back to the middle.
+Global interpolateGlobal(const Global* previous, const Global* current, float alpha);
+
+#endif //PONG_SCHEDULER_H
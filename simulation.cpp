@@ -0,0 +1,461 @@
+// Pong simulation core.
+// Game state and the per-tick update functions. Nothing in this file touches GLUT or OpenGL.
+
+#include "profiler.h"
+#include "simulation.h"
+#include "simulation_kernels.h"
+
+Global global;
+
+#if defined(PONG_HAS_ASM_KERNELS) && !defined(PONG_PORTABLE_KERNELS)
+#define PONG_ASM_KERNELS
+#endif
+
+const char* simulationKernels(){
+#ifdef PONG_ASM_KERNELS
+    return "asm";
+#else
+    return "portable";
+#endif
+}
+
+void initGlobals(){
+    //Initializes the global variables
+    //They are all under the global struct, and can be access using global.variableName
+    //You should not change this function.
+    global.playerPaddlePosition = initialPlayerPaddlePosition;
+    global.aiPaddlePosition = initialAiPaddlePosition;
+    global.playerScore = 0;
+    global.aiScore = 0;
+    global.ballPosition = initialBallPosition;
+    global.ballSpeed = initialBallSpeed;
+    global.ballDirection = initialBallDirection;
+    global.lastScore = 0;
+    global.gameOver = 0;
+    global.introScreen = 0;
+}
+
+#ifdef PONG_HAS_ASM_KERNELS
+//The asm blocks below define global labels, so each function containing one must be emitted exactly once.
+//Keep the optimizer from inlining or cloning them into their callers.
+#if defined(__clang__)
+#define ASM_KERNEL __attribute__((noinline))
+#else
+#define ASM_KERNEL __attribute__((noinline, noclone))
+#endif
+
+ASM_KERNEL void asmResetBall(){
+    //EXAMPLE:
+    //This is an example of how your assembly functions should look like.
+    //You can use this as a template for your own code.
+    //I've provided the original C code that I wrote, and the corresponding assembly code.
+    //I recommend that you first write the C code and test if it works. Then you can convert it to assembly.
+
+    //Resets the ball to the initial position and speed.
+    //The ball will go in the opposite direction of the last player to score
+
+    //C code:
+    //global.ballPosition = initialBallPosition;
+    //if (global.lastScore == 0){
+    //    global.ballDirection = (Point) {-initialBallDirection.x, initialBallDirection.y};
+    //}
+    //else {
+    //    global.ballDirection = initialBallDirection;
+    //}
+    //global.ballSpeed = initialBallSpeed;
+
+    //Assembly code:
+    //You should always use __volatile__ to prevent the compiler from incorrectly optimizing away your code.
+    //__asm__ is the keyword to start writing assembly code.
+    //GCC uses AT&T syntax, which is different from Intel syntax that we have been using so far.
+    //The biggest changes are that the parameters are in reverse order.
+    //Registers are prefixed with a % sign. (Two % in our case to avoid the compiler from interpreting it as a positional argument)
+    //Integer literals are prefixed with a $ sign.
+    //To refer to the memory pointed to by a register you must use the () syntax.
+    //When a label is created, it can be referenced from anywhere in the code, so ensure your labels are unique.
+    __asm__ __volatile__(
+        //%0 is the first parameter, %1 is the second parameter, and so on.
+        //The parameters start counting from the output parameters then to the input parameters.
+        //So %5 in this case is the first input parameter(initialBallPosition.x).
+        //And %0 is the first output parameter(global.ballPosition.x).
+        //You must include the newline character at the end of each line.
+            "mov %5, %0\n" //This is equivalent to global.ballPosition.x = initialBallPosition.x; in C.
+            "mov %6, %1\n" // global.ballPosition.y = initialBallPosition.y;
+            "cmp $0, %10\n" // if (global.lastScore == 0)
+            "jne resetBallPlayer\n" // {
+            "mov %7, %%eax\n" // eax = initialBallDirection.x
+            "imul $-1, %%eax\n" // eax = -initialBallDirection.x
+            "mov %%eax, %2\n" // global.ballDirection.x = -initialBallDirection.x;
+            "mov %8, %3\n" // global.ballDirection.y = initialBallDirection.y;
+            "jmp resetBallEnd\n" // }
+            "resetBallPlayer:\n" // else {
+            "mov %7, %2\n" // global.ballDirection.x = initialBallDirection.x;
+            "mov %8, %3\n" // global.ballDirection.y = initialBallDirection.y;
+            "resetBallEnd:\n" // }
+            "mov %9, %4\n" // global.ballSpeed = initialBallSpeed;
+            //An example of how to use the eax register, and integer literals.
+            "mov $0, %%eax\n" //Now eax is 0
+            : "=m" (global.ballPosition.x), "=m" (global.ballPosition.y), "=m" (global.ballDirection.x), "=m" (global.ballDirection.y), "=m" (global.ballSpeed)
+        //Output parameters go here. Use "=r" for values stored in registers, use "=m" for values stored in memory
+            : "r" (initialBallPosition.x), "r" (initialBallPosition.y), "r" (initialBallDirection.x), "r" (initialBallDirection.x), "r" (initialBallSpeed), "r" (global.lastScore)
+        //Input parameters go here use "r" for values stored in registers, use "m" for values stored in memory
+            : "eax"
+        //You should list all the registers you use here, because they will be clobbered and the compiler has to know which ones to save
+            );
+}
+#endif
+
+void resetBall(){
+#ifdef PONG_ASM_KERNELS
+    asmResetBall();
+#else
+    portableResetBall(&global);
+#endif
+}
+
+void updateBall(){
+    PROFILE_SCOPE("updateBall");
+    //Check if the ball collides with the edges of the screen, and check if it collides with the paddles.
+    //If the ball collides with the edges of the screen, it will add a point to the other player and reset the ball.
+    //If the ball collides with the paddles, it will change the x direction of the ball.
+    //If the ball collides with the top or bottom of the screen, it will change the y direction of the ball.
+    //The ball will also increase in speed every time it collides with the AI paddle.
+    //Update the ball position using the global.ballSpeed and global.ballDirection variables
+    //Make sure to update the global.lastScore variable to indicate who scored the last point
+
+
+    //paddle collisions
+
+    //ball
+    int ballX1 = global.ballPosition.x;
+    int ballY1 = global.ballPosition.y;
+    int ballX2 = global.ballPosition.x + ballSideLength;
+    int ballY2 = global.ballPosition.y + ballSideLength;
+
+    //player collision
+    int playerX1 = global.playerPaddlePosition.x;
+    int playerY1 = global.playerPaddlePosition.y;
+    int playerX2 = global.playerPaddlePosition.x + paddleWidth;
+    int playerY2 = global.playerPaddlePosition.y + paddleLength;
+    bool playerCollisionY = (playerY1 <= ballY1 && ballY1 <= playerY2) || (playerY1 <= ballY2 && ballY2 <= playerY2);
+    bool playerCollisionX = (playerX1 <= ballX1 && ballX1 <= playerX2) || (playerX1 <= ballX2 && ballX2 <= playerX2);
+    bool playerCollision = playerCollisionX && playerCollisionY;
+
+    //AICollision
+    int AIX1 = global.aiPaddlePosition.x;
+    int AIY1 = global.aiPaddlePosition.y;
+    int AIX2 = global.aiPaddlePosition.x + paddleWidth;
+    int AIY2 = global.aiPaddlePosition.y + paddleLength;
+    bool AICollisionY = (AIY1 <= ballY1 && ballY1 <= AIY2) || (AIY1 <= ballY2 && ballY2 <= AIY2);
+    bool AICollisionX = (AIX1 <= ballX1 && ballX1 <= AIX2) || (AIX1 <= ballX2 && ballX2 <= AIX2);
+    bool AICollision = AICollisionX && AICollisionY;
+
+    if (playerCollision || AICollision) {
+        global.ballDirection.x = global.ballDirection.x * -1.0f;
+    }
+
+
+
+    //wall collision
+    bool pastCeiling = global.ballPosition.y <= (0 + wallThickness);
+    bool pastFloor = global.ballPosition.y >= (screenHeight - wallThickness);
+    bool pastLWall = global.ballPosition.x <= (0 + wallThickness);
+    bool pastRWall = global.ballPosition.x >= (screenWidth - wallThickness);
+    if(pastCeiling || pastFloor) {
+        global.ballDirection.y = global.ballDirection.y * -1.0f;
+    }
+    if(pastLWall || pastRWall) {
+        global.ballDirection.x = global.ballDirection.x * -1.0f;
+    }
+    if (pastCeiling) {
+        global.ballPosition.y = 0 + wallThickness;
+    }
+    if (pastFloor) {
+        global.ballPosition.y = screenHeight - wallThickness;
+    }
+
+    //goal collision
+    int goalTop = goalPosition - (goalHeight/2);
+    int goalBottom = goalPosition + (goalHeight/2);
+    bool ballInGoalBoundsY1 = ballY1 >= goalTop && ballY1 <= goalBottom ;
+    bool ballInGoalBoundsY2 = ballY2 >= goalTop && ballY2 <= goalBottom ;
+    bool ballInGoalBounds = ballInGoalBoundsY1 && ballInGoalBoundsY2;
+    if (ballInGoalBounds && pastLWall) {
+        global.playerScore +=1;
+        global.lastScore =1;
+        resetBall();
+    }
+    else if (ballInGoalBounds && pastRWall) {
+        global.aiScore +=1;
+        global.lastScore =0;
+        resetBall();
+    } else {
+        //move ball
+        global.ballPosition.x = global.ballPosition.x + (global.ballDirection.x * global.ballSpeed);
+        global.ballPosition.y = global.ballPosition.y + (global.ballDirection.y * global.ballSpeed);
+    }
+
+
+
+
+
+
+
+}
+
+#ifdef PONG_HAS_ASM_KERNELS
+ASM_KERNEL void asmUpdateAI(){
+    //The AI is very simple, it just follows the ball on the Y axis only if the ball is on the left side of the screen
+    //It moves at the speed set by the global.aiSpeed variable
+
+    //C++ version of updateAI
+
+    //check to see if the ball is on the AI side
+
+
+//    int ballX2 = global.ballPosition.x + ballSideLength;
+//
+//
+//
+//
+//    int midPoint = screenWidth / 2;
+//    bool onSide = (ballX2 <= midPoint) ;
+//    if (!onSide) {
+//        return;
+//    }
+//
+//    int ballCenter = global.ballPosition.y + (ballSideLength / 2);
+//    int aiPaddleCenter = global.aiPaddlePosition.y + (paddleLength / 2);
+//    int ballDistance = ballCenter - aiPaddleCenter ;
+//    //subtract the AIplayer position from ball position
+//    //check to see that the ball is more than ball.speed away y direction
+//
+//    // if the result is positive, subtract the speed from the AI position
+//    if (ballDistance > initialBallSpeed) {
+//        global.aiPaddlePosition.y += initialBallSpeed;
+//    }
+//
+//    //if the result is negative, add the speed to the AI position
+//    if (ballDistance < -initialBallSpeed) {
+//        global.aiPaddlePosition.y -= initialBallSpeed;
+//    }
+
+
+    //ASM
+
+    int screenW = screenWidth;
+
+    __asm__ __volatile__(
+
+        //CHECK TO SEE IF BALL IS ON THE CORRECT SIDE
+
+        "mov %6, %%eax\n"//move screen with into eax
+        "shr $1, %%eax\n"//divide screen width by two, register eax
+        "mov %1, %%ebx\n"//move the ball x position into register ebx
+        "add %4, %%ebx\n"//add the ball length to the ball position at ebx
+        "cmp %%ebx, %%eax\n"//cmp screen with ball x position
+        "jle endUpdateAI\n"//jump to end if the ball x position is less than screen width divided by 2
+
+        //CALCULATE BALL CENTER
+
+        "mov %4, %%eax\n"//move ball side length into register eax
+        "shr $1, %%eax\n"//divide it by 2
+        "mov %2, %%ebx\n"//move the ball y position into register ebx
+        "add %%ebx, %%eax\n"//add it to ball side length at eax
+
+        //CALCULATE PADDLE CENTER
+        "mov %3, %%ebx\n"//move paddle length into a register ebx
+        "shr $1, %%ebx\n"//divide paddle length by 2 ebx
+
+        //CALCULATE DISTANCE TO BALL FROM PADDLE
+
+        "sub %%ebx, %%eax\n"//subtract the paddle length from the ball center (eax - ebx)
+        "mov %0, %%ecx\n"//mov paddle y position into register ecx
+        "sub %%ecx, %%eax\n"//subtract the paddle y position from the ball center (eax - ecx)
+
+        //MOVE PADDLE DOWN IF BALL BELOW
+
+        "paddleDown:\n"//paddle down
+        "mov %5, %%ebx\n"//mov initial ball speed into register ebx
+        "cmp %%ebx, %%eax\n"//cmp with ball distance
+        "jle paddleUp\n"//if ball distance less than or equal to init ball speed jump to paddle up (eba <= ebx)
+
+        "mov %7, %%ebx\n" //move paddle speed into register
+        "add %%ebx, %%ecx\n"//add paddle speed to position (ecx + ebx)
+        "mov %%ecx, %0\n"//move ecx into paddle position mem
+        "jmp endUpdateAI\n"//jump to end
+
+        //MOVE PADDLE UP IF BALL ABOVE
+
+        "paddleUp:\n"// label paddle up
+        "neg %%ebx\n"//Make initBallSpeed negative
+        "cmp %%ebx, %%eax\n"//compare with ball distance
+        "jge endUpdateAI\n"//if ball distance greater than or equal to -initialBallSpeed than jump to end (eax >= ebx)
+
+        "mov %7, %%ebx\n" //move paddle speed into register
+//        "neg %%ebx\n"
+        "sub %%ebx, %%ecx\n"//subtract paddleSpeed from y position (ecx - ebx)
+        "mov %%ecx, %0\n"//move ecx into paddle position mem
+        "jmp endUpdateAI\n"//jump to end
+
+        "endUpdateAI:\n"//label end update ai
+
+        // %0 -  global.playerPaddlePosition
+        : "=m" (global.aiPaddlePosition.y)
+        // %1 - ballX                    %2 - bally                 $3 - paddleLength   $4 - ballLength       $5 - ballSpeed         $6 - screenwidth  $7 - paddleSpeed
+        : "m" (global.ballPosition.x), "m" (global.ballPosition.y), "r" (paddleLength), "m" (ballSideLength), "m" (initialBallSpeed), "r" (screenW), "m" (aiPaddleSpeed)
+        : "eax", "ebx", "ecx" // Clobbered register
+    );
+
+
+
+
+}
+#endif
+
+void updateAI(){
+    PROFILE_SCOPE("updateAI");
+#ifdef PONG_ASM_KERNELS
+    asmUpdateAI();
+#else
+    portableUpdateAI(&global);
+#endif
+}
+
+void gameLogic(){
+    PROFILE_SCOPE("gameLogic");
+    //The game is over when one of the players reaches 9 points otherwise call updateBall and updateAI
+    //Make sure to update the global.gameOver variable
+    if (global.introScreen == 0) {
+        return;
+    }
+
+    if (global.gameOver == 0) {
+
+        updateBall();
+        updateAI();
+    }
+
+    if (global.playerScore >= winningScore || global.aiScore >= winningScore) {
+        global.gameOver = 1;
+    }
+
+
+
+}
+
+
+#ifdef PONG_HAS_ASM_KERNELS
+void asmMouse(int x, int y){
+    //The paddle is always centered on the mouse
+
+    //move players paddle to y coordinate
+
+    __asm__ __volatile__(
+        "mov %3, %%eax\n" // move the paddle size into register
+        "shr $1, %%eax\n" // divide by paddle size by 2 to get center
+        "mov %1, %%ebx\n" //move the mouse position into register
+        "sub %%eax, %%ebx\n" // subtract paddle size from mouse position to center it
+        "mov %%ebx, %0\n" // Move the value from centered new paddle value into paddle position
+        // %0 -  global.playerPaddlePosition
+        : "=m" (global.playerPaddlePosition.y)
+        // %1 - y   %2 - global.playerPaddlePosition.y  $3 - paddleLength
+        : "m" (y), "m" (global.playerPaddlePosition.y), "m" (paddleLength)
+        : "eax", "ebx" // Clobbered register
+    );
+}
+
+ASM_KERNEL void asmKeyPressed(unsigned char key){
+    //Pressing 'r' resets the game if the game is over
+
+    //check if game is over, if not return
+//    if (global.gameOver == 0) {
+//        return;
+//    }
+//    //if game is over then check the r key was pressed,
+//    if (key == 'r') {
+//        resetGame();
+//    } else {
+//        exit(0);
+//    }
+    //if so then reset the game
+
+    //else then quit the application
+
+    __asm__ __volatile__(
+
+        "mov $1, %4\n"
+
+        "mov %5, %%eax\n"//move gameover into eax
+        "cmp $0, %%eax\n"//compare with 0
+        "je keyboardEnd\n"//jump to end if equal
+
+
+
+        "cmp $0x72, %6\n"//cmp key to r (ascii=0x72)
+        "jne otherKeyPressed\n"//if not equal jmp to other key pressed
+
+        "mov %7, %0\n"//set player position to initial position
+        "mov %8, %1\n"//set aiposition to initial position
+        "mov $0, %2\n"//set player score to 0
+        "mov $0, %3\n"//set ai score to 0
+        "mov $0, %5\n"//set set gameover to 0
+        "jmp keyboardEnd\n"
+
+        //label othekeypressed
+
+        //exit the program
+
+        "otherKeyPressed:\n"
+
+
+        "keyboardEnd:\n"//label end of function
+
+
+         // %0 - playerpaddle                 %1 - aipaddle                     %2 - playerscore        %3 - aiscore            %4-introscreen
+        : "=m" (global.playerPaddlePosition), "=m" (global.aiPaddlePosition), "=m" (global.playerScore), "=m" (global.aiScore), "=m" (global.introScreen)
+        // %5 - gameover          %6 - key   %7 - initplayerpaddle               %8 -initaipaddle
+        : "m" (global.gameOver),  "r" (key), "r" (initialPlayerPaddlePosition), "r" (initialAiPaddlePosition)
+
+        : "eax", "ebx", "ecx" // Clobbered register
+    );
+}
+#endif
+
+void mouse(int x, int y){
+#ifdef PONG_ASM_KERNELS
+    asmMouse(x, y);
+#else
+    portableMouse(&global, y);
+#endif
+}
+
+void keyPressed(unsigned char key){
+#ifdef PONG_ASM_KERNELS
+    asmKeyPressed(key);
+#else
+    portableKeyPressed(&global, key);
+#endif
+}
+
+void resetGame(){
+    global.playerPaddlePosition = initialPlayerPaddlePosition;
+    global.aiPaddlePosition = initialAiPaddlePosition;
+    global.playerScore = 0;
+    global.aiScore = 0;
+    global.gameOver = 0;
+}
+
+int scriptedPlayerY(long tick){
+    //Triangle wave between the top and bottom walls, moving 107 pixels every 3 ticks.
+    //The period is deliberately unrelated to the ball's bounce period, so rallies end. At a whole number of pixels
+    //per tick the ball only ever gets past the player; at this speed some rallies also end past the AI.
+    const int top = wallThickness + paddleLength / 2;
+    const int bottom = screenHeight - wallThickness - paddleLength / 2;
+    const int range = bottom - top;
+    int phase = (int) ((tick * 107 / 3) % (2 * range));
+    if (phase < range) {
+        return top + phase;
+    }
+    return bottom - (phase - range);
+}
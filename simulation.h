@@ -0,0 +1,71 @@
+// Pong simulation core.
+// Everything needed to advance a match lives here, with no dependency on GLUT or OpenGL,
+// so it can be linked into the windowed game as well as into the headless tools.
+
+#ifndef PONG_SIMULATION_H
+#define PONG_SIMULATION_H
+
+//Represents a point in 2D space
+//x and y are in pixels
+typedef struct Point{
+    int x; //Pixels
+    int y; //Pixels
+} Point;
+
+//Global variables struct
+typedef struct Global{
+    Point playerPaddlePosition;
+    Point aiPaddlePosition;
+    int playerScore;
+    int aiScore;
+    Point ballPosition;
+    int ballSpeed; //Pixels/Frame
+    Point ballDirection;
+    int lastScore; //0 = player, 1 = ai
+    int gameOver; //0 = false, 1 = true
+    int introScreen; //0 on intro screen, 1 in game
+} Global;
+extern Global global;
+
+//Consts you should not change these values.
+#define screenWidth 1920
+#define screenHeight 1080
+#define paddleOffset 120
+#define scoreSize 22
+const int aiPaddleSpeed = 30;
+const int scoreGap = 50;
+const int ballSpeedupFactor = 1;
+const int paddleWidth = 40;
+const int paddleLength = 200;
+const int ballSideLength = 30;
+const int initialBallSpeed = 30;
+const int scorePosition = screenHeight * 0.9;
+const int goalPosition = screenHeight / 2;
+const int goalHeight = screenHeight / 3;
+const int wallThickness = 20;
+const int winningScore = 9;
+const Point playerScorePosition = (Point){screenWidth - paddleOffset, scorePosition};
+const Point aiScorePosition = (Point){paddleOffset - scoreSize, scorePosition};
+const Point initialBallPosition = (Point) {screenWidth / 2, screenHeight / 2};
+const Point initialBallDirection = (Point) {1, 1};
+const Point initialPlayerPaddlePosition = (Point){screenWidth - paddleOffset - paddleWidth, (screenHeight / 2) - paddleLength / 2};
+const Point initialAiPaddlePosition = (Point){paddleOffset, (screenHeight / 2) - (paddleLength / 2)};
+
+void initGlobals();
+void resetBall();
+void updateBall();
+void updateAI();
+void gameLogic();
+void mouse(int x, int y);
+
+//Game side of a key press: leaves the intro screen, and 'r' resets a finished game.
+//Quitting on other keys is left to the caller.
+void keyPressed(unsigned char key);
+void resetGame();
+
+//Scripted stand-in for the mouse, used by the headless tools.
+//Returns the mouse y coordinate for the given tick. The paddle sweeps the field at a fixed speed,
+//so it returns some balls and misses others, both sides score, and every match eventually reaches winningScore.
+int scriptedPlayerY(long tick);
+
+#endif //PONG_SIMULATION_H
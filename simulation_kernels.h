@@ -0,0 +1,65 @@
+// Portable simulation kernels.
+// resetBall(), updateAI(), mouse() and keyPressed() were written as x86 asm blocks. Those define global labels,
+// so the compiler can't inline or clone them, and they only build on x86-64. The functions here compute the
+// same results in plain C++ on any Global, so they inline into loops over many states and build everywhere.
+// They are the step functions of game_config.h with the standard arena, which follow the asm blocks step for
+// step, including the shifts used to halve lengths. portableUpdateBall() is updateBall() on any Global.
+//
+// simulation.cpp uses them for the global functions when built with PONG_PORTABLE_KERNELS, and always on other
+// architectures. On x86-64 the asm versions stay available as asmResetBall() and so on, to check the two against
+// each other (pong_headless --kernels) and to time them (pong_bench).
+
+#ifndef PONG_SIMULATION_KERNELS_H
+#define PONG_SIMULATION_KERNELS_H
+
+#include "game_config.h"
+#include "simulation.h"
+
+#if defined(__x86_64__)
+#define PONG_HAS_ASM_KERNELS
+#endif
+
+//resetBall(): the ball back in the middle, served away from whoever scored last
+inline void portableResetBall(Global* state){
+    arenaResetBall(state, StandardArena::get());
+}
+
+//updateBall() on state instead of global, for the tools that step many games
+inline void portableUpdateBall(Global* state){
+    arenaUpdateBall(state, StandardArena::get());
+}
+
+//updateAI(): while the ball is on its half, the AI paddle moves toward it unless it's within a ball speed
+inline void portableUpdateAI(Global* state){
+    arenaUpdateAI(state, StandardArena::get());
+}
+
+//mouse(): the player paddle centered on y
+inline void portableMouse(Global* state, int y){
+    state->playerPaddlePosition.y = y - (paddleLength >> 1);
+}
+
+//keyPressed(): leaves the intro screen, and 'r' on a finished game puts the paddles and scores back
+inline void portableKeyPressed(Global* state, unsigned char key){
+    state->introScreen = 1;
+    if (state->gameOver != 0 && key == 'r') {
+        state->playerPaddlePosition = initialPlayerPaddlePosition;
+        state->aiPaddlePosition = initialAiPaddlePosition;
+        state->playerScore = 0;
+        state->aiScore = 0;
+        state->gameOver = 0;
+    }
+}
+
+//Name of the kernels the global functions use, "asm" or "portable"
+const char* simulationKernels();
+
+#ifdef PONG_HAS_ASM_KERNELS
+//The asm kernels, on global
+void asmResetBall();
+void asmUpdateAI();
+void asmMouse(int x, int y);
+void asmKeyPressed(unsigned char key);
+#endif
+
+#endif //PONG_SIMULATION_KERNELS_H
@@ -0,0 +1,134 @@
+// Software renderer, see soft_renderer.h.
+
+#include <stdlib.h>
+#include <string.h>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "font_data.h"
+#include "game_scene.h"
+#include "profiler.h"
+#include "soft_renderer.h"
+
+uint32_t packColor(Color color){
+    unsigned char bytes[4] = {color.r, color.g, color.b, 255};
+    uint32_t value;
+    memcpy(&value, bytes, 4);
+    return value;
+}
+
+void fillSpan(uint32_t* span, int count, uint32_t value){
+    int i = 0;
+#if defined(__AVX2__)
+    __m256i wide = _mm256_set1_epi32((int) value);
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_si256((__m256i*) (span + i), wide);
+    }
+#endif
+#if defined(__SSE2__)
+    __m128i vector = _mm_set1_epi32((int) value);
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_si128((__m128i*) (span + i), vector);
+    }
+#endif
+    for (; i < count; i++) {
+        span[i] = value;
+    }
+}
+
+int initSoftFramebuffer(SoftFramebuffer* framebuffer, int width, int height){
+    framebuffer->width = width;
+    framebuffer->height = height;
+    framebuffer->pixels = (uint32_t*) malloc(sizeof(uint32_t) * width * height);
+    return framebuffer->pixels ? 0 : -1;
+}
+
+void destroySoftFramebuffer(SoftFramebuffer* framebuffer){
+    free(framebuffer->pixels);
+    framebuffer->pixels = NULL;
+}
+
+void clearSoftFramebuffer(SoftFramebuffer* framebuffer){
+    fillSpan(framebuffer->pixels, framebuffer->width * framebuffer->height, packColor((Color){0, 0, 0}));
+}
+
+void softFillRect(SoftFramebuffer* framebuffer, int x1, int y1, int x2, int y2, Color color){
+    x1 = x1 < 0 ? 0 : x1;
+    y1 = y1 < 0 ? 0 : y1;
+    x2 = x2 > framebuffer->width ? framebuffer->width : x2;
+    y2 = y2 > framebuffer->height ? framebuffer->height : y2;
+    if (x1 >= x2 || y1 >= y2) {
+        return;
+    }
+    uint32_t value = packColor(color);
+    for (int y = y1; y < y2; y++) {
+        uint32_t* row = framebuffer->pixels + (size_t) (framebuffer->height - 1 - y) * framebuffer->width;
+        fillSpan(row + x1, x2 - x1, value);
+    }
+}
+
+void softDrawText(SoftFramebuffer* framebuffer, const char* text, int x, int y, int scale, Color color){
+    //Same layout as the glyph atlas renderers. Each run of set pixels in a glyph row is one fill.
+    int top = y - glyphBaseline * scale;
+    for (int i = 0; text[i]; i++) {
+        int left = x + i * glyphAdvance * scale;
+        for (int row = 0; row < glyphHeight; row++) {
+            int column = 0;
+            while (column < glyphWidth) {
+                if (!glyphPixel(text[i], column, row)) {
+                    column++;
+                    continue;
+                }
+                int start = column;
+                while (column < glyphWidth && glyphPixel(text[i], column, row)) {
+                    column++;
+                }
+                softFillRect(framebuffer, left + start * scale, top + row * scale,
+                             left + column * scale, top + (row + 1) * scale, color);
+            }
+        }
+    }
+}
+
+//Framebuffer the scene is drawn into
+SoftFramebuffer* softTarget = NULL;
+
+void softRect(int x1, int y1, int x2, int y2, Color color){
+    softFillRect(softTarget, x1, y1, x2, y2, color);
+}
+
+void softText(const char* text, int x, int y, int scale, Color color){
+    softDrawText(softTarget, text, x, y, scale, color);
+}
+
+const SceneOutput softSceneOutput = {softRect, softText};
+
+void drawSoftGameView(SoftFramebuffer* framebuffer, const Global* state, const Global* view){
+    PROFILE_SCOPE("drawSoftGameView");
+    softTarget = framebuffer;
+    sceneOutput = &softSceneOutput;
+    clearSoftFramebuffer(framebuffer);
+    if (state->introScreen == 0) {
+        drawIntroText();
+        return;
+    }
+
+    //Same order as drawGameView
+    drawMidfieldLine();
+    drawPaddle(view);
+    drawBall(view);
+    drawScore(view);
+    drawWalls();
+    drawSceneText(state, view);
+}
+
+const char* softRendererIsa(){
+#if defined(__AVX2__)
+    return "avx2";
+#elif defined(__SSE2__)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
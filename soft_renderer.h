@@ -0,0 +1,42 @@
+// Software renderer.
+// Rasterizes the game scene (see game_scene.h) into an RGBA framebuffer in memory, with no OpenGL at all. Every
+// rect and glyph pixel of the scene is an axis aligned fill, done a row span at a time with SIMD stores.
+// Output matches the OpenGL renderers pixel for pixel, except on the intro screen where only the text is drawn.
+//
+// Rows are stored bottom up like OpenGL's, so a frame can go straight to glDrawPixels or frame capture and be
+// compared with glReadPixels as is.
+
+#ifndef PONG_SOFT_RENDERER_H
+#define PONG_SOFT_RENDERER_H
+
+#include <stdint.h>
+
+#include "color.h"
+#include "simulation.h"
+
+typedef struct SoftFramebuffer{
+    int width;
+    int height;
+    uint32_t* pixels; //RGBA bytes in memory order, row 0 is the bottom of the screen
+} SoftFramebuffer;
+
+//Returns 0 on success
+int initSoftFramebuffer(SoftFramebuffer* framebuffer, int width, int height);
+void destroySoftFramebuffer(SoftFramebuffer* framebuffer);
+
+//Fills the whole framebuffer with opaque black
+void clearSoftFramebuffer(SoftFramebuffer* framebuffer);
+
+//Fills pixels [x1, x2) x [y1, y2), y down from the top of the screen, clipped to the framebuffer
+void softFillRect(SoftFramebuffer* framebuffer, int x1, int y1, int x2, int y2, Color color);
+
+//Text with its left end at x and its baseline at y, scale pixels per font pixel
+void softDrawText(SoftFramebuffer* framebuffer, const char* text, int x, int y, int scale, Color color);
+
+//Same frame drawGameView draws
+void drawSoftGameView(SoftFramebuffer* framebuffer, const Global* state, const Global* view);
+
+//Instruction set the span fills were compiled for
+const char* softRendererIsa();
+
+#endif //PONG_SOFT_RENDERER_H
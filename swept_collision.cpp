@@ -0,0 +1,144 @@
+// Continuous collision for the ball, see swept_collision.h.
+
+#include "simulation_kernels.h"
+#include "swept_collision.h"
+
+void sweptBoxes(const Global* state, SweptBox* boxes){
+    boxes[0] = (SweptBox){-sweptFar, -sweptFar, sweptFar, wallThickness, SWEPT_WALL};
+    boxes[1] = (SweptBox){-sweptFar, screenHeight - wallThickness, sweptFar, sweptFar, SWEPT_WALL};
+    boxes[2] = (SweptBox){-sweptFar, -sweptFar, wallThickness, sweptFar, SWEPT_LEFT_SIDE};
+    boxes[3] = (SweptBox){screenWidth - wallThickness, -sweptFar, sweptFar, sweptFar, SWEPT_RIGHT_SIDE};
+    boxes[4] = (SweptBox){state->playerPaddlePosition.x, state->playerPaddlePosition.y,
+                          state->playerPaddlePosition.x + paddleWidth, state->playerPaddlePosition.y + paddleLength,
+                          SWEPT_PADDLE};
+    boxes[5] = (SweptBox){state->aiPaddlePosition.x, state->aiPaddlePosition.y,
+                          state->aiPaddlePosition.x + paddleWidth, state->aiPaddlePosition.y + paddleLength,
+                          SWEPT_PADDLE};
+}
+
+int directionSign(int value){
+    return (value > 0) - (value < 0);
+}
+
+//Times at which the ball's span [position, position + ballSideLength] first and last overlaps [low, high]
+//while moving by direction per unit of time
+void axisWindow(int position, int direction, int low, int high, long* entry, long* exit){
+    const long never = 4L * sweptFar;
+    if (direction > 0) {
+        *entry = (long) low - ballSideLength - position;
+        *exit = (long) high - position;
+    } else if (direction < 0) {
+        *entry = (long) position - high;
+        *exit = (long) position + ballSideLength - low;
+    } else if (position + ballSideLength >= low && position <= high) {
+        *entry = -never;
+        *exit = never;
+    } else {
+        *entry = never;
+        *exit = -never;
+    }
+}
+
+int ballInGoal(int ballY){
+    int goalTop = goalPosition - (goalHeight / 2);
+    int goalBottom = goalPosition + (goalHeight / 2);
+    return ballY >= goalTop && ballY + ballSideLength <= goalBottom;
+}
+
+long sweepBall(Global* state, long ticks){
+    SweptBox boxes[sweptBoxCount];
+    sweptBoxes(state, boxes);
+
+    long done = 0; //Whole ticks finished before the current tick started
+    long elapsed = 0; //Units since the start of tick done
+    while (done < ticks) {
+        long speed = state->ballSpeed;
+        if (speed <= 0) {
+            return ticks;
+        }
+        int dx = directionSign(state->ballDirection.x);
+        int dy = directionSign(state->ballDirection.y);
+        long remaining = (ticks - done) * speed - elapsed;
+
+        //Earliest contact in (0, remaining]. Everything touched at that time is handled together, so hitting a
+        //corner, or a paddle and a wall at once, bounces on both axes.
+        long contact = remaining + 1;
+        int flipX = 0;
+        int flipY = 0;
+        int goal = 0;
+        for (int i = 0; i < sweptBoxCount; i++) {
+            const SweptBox* box = &boxes[i];
+            long entryX, exitX, entryY, exitY;
+            axisWindow(state->ballPosition.x, dx, box->x1, box->x2, &entryX, &exitX);
+            axisWindow(state->ballPosition.y, dy, box->y1, box->y2, &entryY, &exitY);
+            long time = entryX > entryY ? entryX : entryY;
+            //A box the ball already touches now was handled when it was hit, or overlapped from the start
+            if (time <= 0 || time > remaining || time > exitX || time > exitY || time > contact) {
+                continue;
+            }
+            if (time < contact) {
+                contact = time;
+                flipX = 0;
+                flipY = 0;
+                goal = 0;
+            }
+            if ((box->kind == SWEPT_LEFT_SIDE || box->kind == SWEPT_RIGHT_SIDE)
+                && ballInGoal(state->ballPosition.y + dy * (int) time)) {
+                goal = box->kind;
+            }
+            flipX |= entryX == time;
+            flipY |= entryY == time;
+        }
+
+        if (contact > remaining) {
+            state->ballPosition.x += dx * (int) remaining;
+            state->ballPosition.y += dy * (int) remaining;
+            return ticks;
+        }
+
+        state->ballPosition.x += dx * (int) contact;
+        state->ballPosition.y += dy * (int) contact;
+        elapsed += contact;
+        if (goal) {
+            //The rest of the tick is lost to the reset, like in updateBall()
+            if (goal == SWEPT_LEFT_SIDE) {
+                state->playerScore += 1;
+                state->lastScore = 1;
+            } else {
+                state->aiScore += 1;
+                state->lastScore = 0;
+            }
+            portableResetBall(state);
+            done += (elapsed + speed - 1) / speed;
+            elapsed = 0;
+            if (state->playerScore >= winningScore || state->aiScore >= winningScore) {
+                return done;
+            }
+            continue;
+        }
+        if (flipX) {
+            state->ballDirection.x = -state->ballDirection.x;
+        }
+        if (flipY) {
+            state->ballDirection.y = -state->ballDirection.y;
+        }
+        done += elapsed / speed;
+        elapsed %= speed;
+    }
+    return done;
+}
+
+void gameLogicSwept(){
+    if (global.introScreen == 0) {
+        return;
+    }
+
+    if (global.gameOver == 0) {
+        sweepBall(&global, 1);
+        updateAI();
+    }
+
+    if (global.playerScore >= winningScore || global.aiScore >= winningScore) {
+        global.gameOver = 1;
+    }
+}
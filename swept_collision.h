@@ -0,0 +1,48 @@
+// Continuous (swept) collision for the ball.
+// updateBall() only tests for overlap where the ball is at the start of a tick, so a ball that moves further
+// than a paddle is wide in one tick can pass straight through it. sweepBall() instead follows the ball along its
+// path and finds the exact time it first touches a wall, a paddle or a goal opening, bounces there and carries on
+// with the rest of the step, so any number of bounces can happen in one step.
+//
+// The ball travels one pixel on each axis per unit of time and a tick is ballSpeed units long. Direction
+// components are -1, 0 or 1 as they are in the game, which keeps every time of impact a whole number of units and
+// the results exact. A goal ends the tick it happens in, like it does in updateBall(), so sweeping n ticks at once
+// gives exactly the same state as sweeping one tick n times, as long as the paddles stay put.
+
+#ifndef PONG_SWEPT_COLLISION_H
+#define PONG_SWEPT_COLLISION_H
+
+#include "simulation.h"
+
+//Things the ball can hit
+enum SweptBoxKind{
+    SWEPT_WALL = 0, //Ceiling and floor
+    SWEPT_LEFT_SIDE = 1, //Left wall, with the AI's goal in it
+    SWEPT_RIGHT_SIDE = 2, //Right wall, with the player's goal in it
+    SWEPT_PADDLE = 3
+};
+
+//Axis aligned box, edges inclusive like the overlap tests in updateBall()
+typedef struct SweptBox{
+    int x1;
+    int y1;
+    int x2;
+    int y2;
+    int kind; //SweptBoxKind
+} SweptBox;
+
+const int sweptBoxCount = 6;
+const int sweptFar = 1 << 20; //Walls reach this far out of the field, so the ball can never get around them
+
+//Fills boxes (sweptBoxCount entries) with the walls and the two paddles of state
+void sweptBoxes(const Global* state, SweptBox* boxes);
+
+//Moves the ball of state forward by ticks ticks, bouncing off walls and paddles and scoring goals on the way.
+//The paddles are held where they are for the whole step. Stops early at the end of a tick in which a goal
+//brought either side to winningScore. Returns the number of ticks that were simulated.
+long sweepBall(Global* state, long ticks);
+
+//Tick by tick loop like gameLogic(), with sweepBall() in place of updateBall()
+void gameLogicSwept();
+
+#endif //PONG_SWEPT_COLLISION_H
@@ -0,0 +1,316 @@
+// Per tick telemetry, see telemetry.h.
+
+#include <chrono>
+#include <stdlib.h>
+#include <string.h>
+
+#include "replay.h"
+#include "telemetry.h"
+
+#define TELEMETRY_COLUMN(field) {#field, offsetof(TelemetryRecord, field), sizeof(((TelemetryRecord*) 0)->field)}
+
+const TelemetryColumn telemetryColumns[telemetryColumnCount] = {
+    TELEMETRY_COLUMN(tick),
+    TELEMETRY_COLUMN(ballX),
+    TELEMETRY_COLUMN(ballY),
+    TELEMETRY_COLUMN(ballDirectionX),
+    TELEMETRY_COLUMN(ballDirectionY),
+    TELEMETRY_COLUMN(ballSpeed),
+    TELEMETRY_COLUMN(playerPaddleY),
+    TELEMETRY_COLUMN(aiPaddleY),
+    TELEMETRY_COLUMN(playerScore),
+    TELEMETRY_COLUMN(aiScore),
+    TELEMETRY_COLUMN(event),
+};
+
+//Worst case bytes of an encoded block: a 10 byte varint per value, each column's size and the padding
+const size_t telemetryMaxBlockBytes = (size_t) telemetryColumnCount * (4 + 10 * (size_t) telemetryBlockRecords) + 8;
+
+int64_t telemetryValue(const TelemetryRecord* record, const TelemetryColumn* column){
+    const char* field = (const char*) record + column->offset;
+    if (column->size == 8) {
+        int64_t value;
+        memcpy(&value, field, 8);
+        return value;
+    }
+    int32_t value;
+    memcpy(&value, field, 4);
+    return value;
+}
+
+void setColumnValue(TelemetryRecord* record, const TelemetryColumn* column, int64_t value){
+    char* field = (char*) record + column->offset;
+    if (column->size == 8) {
+        memcpy(field, &value, 8);
+    } else {
+        int32_t narrow = (int32_t) value;
+        memcpy(field, &narrow, 4);
+    }
+}
+
+//writeVarint into memory, returns the bytes written
+size_t putVarint(unsigned char* out, uint64_t value){
+    size_t length = 0;
+    while (value >= 0x80) {
+        out[length++] = (unsigned char) ((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    out[length++] = (unsigned char) value;
+    return length;
+}
+
+//Deltas, zigzagged. A changed value's delta is never 0 after zigzag, so 0 marks a run of unchanged values and is
+//followed by the run length minus one.
+size_t encodeColumn(const TelemetryRecord* records, int count, const TelemetryColumn* column, unsigned char* out){
+    size_t length = 0;
+    int64_t previous = 0;
+    int i = 0;
+    while (i < count) {
+        int64_t value = telemetryValue(&records[i], column);
+        if (value != previous) {
+            length += putVarint(out + length, zigzag(value - previous));
+            previous = value;
+            i++;
+            continue;
+        }
+        int run = 1;
+        while (i + run < count && telemetryValue(&records[i + run], column) == previous) {
+            run++;
+        }
+        length += putVarint(out + length, 0);
+        length += putVarint(out + length, (uint64_t) (run - 1));
+        i += run;
+    }
+    return length;
+}
+
+int decodeColumn(const unsigned char* data, long size, const TelemetryColumn* column, TelemetryRecord* records,
+                 int count){
+    long cursor = 0;
+    int64_t previous = 0;
+    int i = 0;
+    while (i < count) {
+        uint64_t code;
+        if (!readVarint(data, size, &cursor, &code)) {
+            return -1;
+        }
+        if (code != 0) {
+            previous += unzigzag(code);
+            setColumnValue(&records[i++], column, previous);
+            continue;
+        }
+        uint64_t run;
+        if (!readVarint(data, size, &cursor, &run) || run >= (uint64_t) (count - i)) {
+            return -1;
+        }
+        for (uint64_t r = 0; r <= run; r++) {
+            setColumnValue(&records[i++], column, previous);
+        }
+    }
+    return cursor == size ? 0 : -1;
+}
+
+void writeTelemetryBlock(TelemetryLog* log){
+    if (log->blockCount == 0) {
+        return;
+    }
+    TelemetryBlockHeader blockHeader;
+    blockHeader.recordCount = log->blockCount;
+    blockHeader.firstTick = log->block[0].tick;
+    blockHeader.lastTick = log->block[log->blockCount - 1].tick;
+    size_t size = 0;
+    for (int c = 0; c < telemetryColumnCount; c++) {
+        uint32_t columnSize = (uint32_t) encodeColumn(log->block, log->blockCount, &telemetryColumns[c],
+                                                      log->encoded + size + 4);
+        memcpy(log->encoded + size, &columnSize, 4);
+        size += 4 + columnSize;
+    }
+    //Padded so the next block header is aligned
+    while (size % 8 != 0) {
+        log->encoded[size++] = 0;
+    }
+    blockHeader.size = (int32_t) size;
+    if (!log->failed && (fwrite(&blockHeader, sizeof(blockHeader), 1, log->file) != 1
+                         || fwrite(log->encoded, 1, size, log->file) != size)) {
+        log->failed = 1;
+    }
+    if (!log->failed) {
+        log->header.recordCount += log->blockCount;
+        log->header.blockCount++;
+    }
+    log->blockCount = 0;
+}
+
+//Drains the ring into blocks until it is stopped and empty. When there is nothing to take it sleeps, so the
+//simulation thread never has to wake it.
+void runTelemetryWriter(TelemetryLog* log){
+    uint64_t tail = log->tail.load(std::memory_order_relaxed);
+    while (true) {
+        //Stopping is set after the last push, so once it is seen the head read after it is final
+        int stopping = log->stopping.load(std::memory_order_acquire);
+        uint64_t head = log->head.load(std::memory_order_acquire);
+        if (head == tail) {
+            if (stopping) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        while (tail != head) {
+            log->block[log->blockCount++] = log->ring[tail & (telemetryRingSize - 1)];
+            tail++;
+            log->tail.store(tail, std::memory_order_release);
+            if (log->blockCount == telemetryBlockRecords) {
+                writeTelemetryBlock(log);
+            }
+        }
+    }
+    writeTelemetryBlock(log);
+}
+
+int startTelemetry(TelemetryLog* log, const char* path){
+    log->file = fopen(path, "wb");
+    if (!log->file) {
+        return -1;
+    }
+    memset(&log->header, 0, sizeof(TelemetryHeader));
+    log->header.magic = telemetryMagic;
+    log->header.version = telemetryVersion;
+    log->header.columnCount = telemetryColumnCount;
+    log->header.blockRecords = telemetryBlockRecords;
+    if (fwrite(&log->header, sizeof(TelemetryHeader), 1, log->file) != 1) {
+        fclose(log->file);
+        return -1;
+    }
+    log->ring = (TelemetryRecord*) malloc(sizeof(TelemetryRecord) * telemetryRingSize);
+    log->block = (TelemetryRecord*) malloc(sizeof(TelemetryRecord) * telemetryBlockRecords);
+    log->encoded = (unsigned char*) malloc(telemetryMaxBlockBytes);
+    log->blockCount = 0;
+    log->failed = 0;
+    log->droppedRecords = 0;
+    log->head.store(0);
+    log->tail.store(0);
+    log->stopping.store(0);
+    log->writer = std::thread(runTelemetryWriter, log);
+    return 0;
+}
+
+int pushTelemetry(TelemetryLog* log, const TelemetryRecord* record){
+    uint64_t head = log->head.load(std::memory_order_relaxed);
+    if (head - log->tail.load(std::memory_order_acquire) == (uint64_t) telemetryRingSize) {
+        log->droppedRecords++;
+        return -1;
+    }
+    log->ring[head & (telemetryRingSize - 1)] = *record;
+    log->head.store(head + 1, std::memory_order_release);
+    return 0;
+}
+
+void makeTelemetryRecord(TelemetryRecord* record, long tick, const Global* before, const Global* state){
+    record->tick = tick;
+    record->ballX = state->ballPosition.x;
+    record->ballY = state->ballPosition.y;
+    record->ballDirectionX = state->ballDirection.x;
+    record->ballDirectionY = state->ballDirection.y;
+    record->ballSpeed = state->ballSpeed;
+    record->playerPaddleY = state->playerPaddlePosition.y;
+    record->aiPaddleY = state->aiPaddlePosition.y;
+    record->playerScore = state->playerScore;
+    record->aiScore = state->aiScore;
+    int playerScored = state->playerScore > before->playerScore;
+    int aiScored = state->aiScore > before->aiScore;
+    //A turn on x away from the side walls, where only the paddles turn the ball
+    int x = before->ballPosition.x;
+    int paddleHit = !playerScored && !aiScored && state->ballDirection.x != before->ballDirection.x
+                    && x > wallThickness && x < screenWidth - wallThickness;
+    record->event = (playerScored ? TELEMETRY_PLAYER_SCORED : 0) | (aiScored ? TELEMETRY_AI_SCORED : 0)
+                    | (state->gameOver && !before->gameOver ? TELEMETRY_GAME_OVER : 0)
+                    | (paddleHit ? TELEMETRY_PADDLE_HIT : 0);
+}
+
+int finishTelemetry(TelemetryLog* log){
+    log->stopping.store(1, std::memory_order_release);
+    log->writer.join();
+    log->header.droppedRecords = log->droppedRecords;
+    if (fseek(log->file, 0, SEEK_SET) != 0 || fwrite(&log->header, sizeof(TelemetryHeader), 1, log->file) != 1) {
+        log->failed = 1;
+    }
+    if (fclose(log->file) != 0) {
+        log->failed = 1;
+    }
+    free(log->ring);
+    free(log->block);
+    free(log->encoded);
+    log->ring = NULL;
+    log->block = NULL;
+    log->encoded = NULL;
+    return log->failed ? -1 : 0;
+}
+
+int openTelemetry(TelemetryReader* reader, const char* path){
+    memset(reader, 0, sizeof(TelemetryReader));
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return -1;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size < (long) sizeof(TelemetryHeader)) {
+        fclose(file);
+        return -1;
+    }
+    reader->data = (unsigned char*) malloc(size);
+    reader->size = size;
+    int read = fread(reader->data, 1, size, file) == (size_t) size;
+    fclose(file);
+    reader->header = (const TelemetryHeader*) reader->data;
+    const TelemetryHeader* header = reader->header;
+    if (!read || header->magic != telemetryMagic || header->version != telemetryVersion
+        || header->columnCount != telemetryColumnCount || header->blockRecords != telemetryBlockRecords
+        || header->blockCount < 0) {
+        closeTelemetry(reader);
+        return -1;
+    }
+
+    reader->blocks = (const TelemetryBlockHeader**) malloc(sizeof(TelemetryBlockHeader*) * (header->blockCount + 1));
+    size_t offset = sizeof(TelemetryHeader);
+    for (long b = 0; b < header->blockCount; b++) {
+        const TelemetryBlockHeader* block = (const TelemetryBlockHeader*) (reader->data + offset);
+        if (offset + sizeof(TelemetryBlockHeader) > reader->size || block->recordCount <= 0
+            || block->recordCount > telemetryBlockRecords || block->size < 0
+            || offset + sizeof(TelemetryBlockHeader) + block->size > reader->size) {
+            closeTelemetry(reader);
+            return -1;
+        }
+        reader->blocks[b] = block;
+        offset += sizeof(TelemetryBlockHeader) + block->size;
+    }
+    return 0;
+}
+
+void closeTelemetry(TelemetryReader* reader){
+    free(reader->data);
+    free(reader->blocks);
+    memset(reader, 0, sizeof(TelemetryReader));
+}
+
+int readTelemetryBlock(const TelemetryReader* reader, long block, TelemetryRecord* records){
+    const TelemetryBlockHeader* header = reader->blocks[block];
+    const unsigned char* data = (const unsigned char*) (header + 1);
+    long offset = 0;
+    for (int c = 0; c < telemetryColumnCount; c++) {
+        uint32_t columnSize;
+        if (offset + 4 > header->size) {
+            return -1;
+        }
+        memcpy(&columnSize, data + offset, 4);
+        offset += 4;
+        if (offset + (long) columnSize > header->size
+            || decodeColumn(data + offset, columnSize, &telemetryColumns[c], records, header->recordCount) != 0) {
+            return -1;
+        }
+        offset += columnSize;
+    }
+    return header->recordCount;
+}
@@ -0,0 +1,134 @@
+// Per tick telemetry.
+// The simulation thread hands one fixed size TelemetryRecord per tick (ball, paddles, scores and what happened)
+// to a writer thread through a single producer, single consumer ring. Pushing never locks or waits: the two
+// sides each own one counter of the ring, and when it is full the record is dropped and counted instead.
+// The writer collects records into blocks and writes each block column by column. Every column is delta
+// encoded against the record before it, zigzagged and written as varints, and runs of unchanged values are
+// written as a count, so a column that doesn't change costs a few bytes per block and the ball's position
+// about two bytes a tick.
+//
+// File layout, all little endian:
+//     TelemetryHeader, rewritten when the log is finished
+//     blocks, each a TelemetryBlockHeader followed by telemetryColumnCount columns of
+//         uint32 size in bytes, then the encoded deltas
+// Each block starts its deltas from zero, so blocks decode on their own and a query can skip a block by its
+// tick range.
+
+#ifndef PONG_TELEMETRY_H
+#define PONG_TELEMETRY_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <thread>
+
+#include "simulation.h"
+
+const uint32_t telemetryMagic = 0x4c4d5450; //"PTML"
+const uint32_t telemetryVersion = 1;
+const int telemetryRingSize = 1 << 14; //Records, a power of two
+const int telemetryBlockRecords = 4096;
+
+//What happened in a tick, TelemetryRecord.event
+enum TelemetryEvent{
+    TELEMETRY_PLAYER_SCORED = 1,
+    TELEMETRY_AI_SCORED = 2,
+    TELEMETRY_GAME_OVER = 4,
+    TELEMETRY_PADDLE_HIT = 8 //The ball turned around at a paddle
+};
+
+typedef struct TelemetryRecord{
+    int64_t tick;
+    int32_t ballX;
+    int32_t ballY;
+    int32_t ballDirectionX;
+    int32_t ballDirectionY;
+    int32_t ballSpeed;
+    int32_t playerPaddleY;
+    int32_t aiPaddleY;
+    int32_t playerScore;
+    int32_t aiScore;
+    int32_t event; //TelemetryEvent bits
+} TelemetryRecord;
+
+//The columns of the file, in the order they are stored
+typedef struct TelemetryColumn{
+    const char* name;
+    size_t offset; //In TelemetryRecord
+    size_t size; //4 or 8 bytes
+} TelemetryColumn;
+
+const int telemetryColumnCount = 11;
+extern const TelemetryColumn telemetryColumns[telemetryColumnCount];
+
+//The value of column in record
+int64_t telemetryValue(const TelemetryRecord* record, const TelemetryColumn* column);
+
+typedef struct TelemetryHeader{
+    uint32_t magic;
+    uint32_t version;
+    int32_t columnCount;
+    int32_t blockRecords;
+    int64_t recordCount; //Records written
+    int64_t droppedRecords; //Records pushed while the ring was full
+    int64_t blockCount;
+} TelemetryHeader;
+
+typedef struct TelemetryBlockHeader{
+    int32_t recordCount;
+    int32_t size; //Bytes of the columns that follow
+    int64_t firstTick;
+    int64_t lastTick;
+} TelemetryBlockHeader;
+
+typedef struct TelemetryLog{
+    //Producer side: head is only written by the simulation thread, tail only by the writer. They are on their
+    //own cache lines so the two threads don't keep taking the line from each other.
+    alignas(64) std::atomic<uint64_t> head; //Records pushed
+    long droppedRecords;
+    alignas(64) std::atomic<uint64_t> tail; //Records taken by the writer
+    alignas(64) std::atomic<int> stopping;
+    TelemetryRecord* ring;
+
+    //Writer side
+    FILE* file;
+    std::thread writer;
+    TelemetryRecord* block; //Records of the block being filled
+    int blockCount;
+    unsigned char* encoded; //Scratch for an encoded block
+    TelemetryHeader header;
+    int failed; //1 once a write has failed, later blocks are dropped
+} TelemetryLog;
+
+//Opens path and starts the writer thread. Returns 0 on success.
+int startTelemetry(TelemetryLog* log, const char* path);
+
+//Hands a record to the writer. Never blocks: returns -1 and counts the record as dropped if the ring is full.
+//Only one thread may push.
+int pushTelemetry(TelemetryLog* log, const TelemetryRecord* record);
+
+//Record of state after tick, with the events since before
+void makeTelemetryRecord(TelemetryRecord* record, long tick, const Global* before, const Global* state);
+
+//Writes what is left in the ring, stops the writer and closes the file. Returns 0 if every record taken from
+//the ring was written.
+int finishTelemetry(TelemetryLog* log);
+
+typedef struct TelemetryReader{
+    unsigned char* data; //The whole file
+    size_t size;
+    const TelemetryHeader* header;
+    //Block positions in data, header->blockCount entries
+    const TelemetryBlockHeader** blocks;
+} TelemetryReader;
+
+//Reads a telemetry file and checks it. Returns 0 on success.
+int openTelemetry(TelemetryReader* reader, const char* path);
+void closeTelemetry(TelemetryReader* reader);
+
+//Decodes block into records (room for telemetryBlockRecords). Returns the number of records, -1 if the block
+//is damaged.
+int readTelemetryBlock(const TelemetryReader* reader, long block, TelemetryRecord* records);
+
+#endif //PONG_TELEMETRY_H
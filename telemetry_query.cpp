@@ -0,0 +1,202 @@
+// Offline queries over telemetry files.
+// Prints a summary of a file (records, drops, how well each column compressed and its range), the score and game
+// over events, or the records of a range of ticks as CSV. Blocks outside the range asked for aren't decoded.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "telemetry.h"
+
+void printUsage(const char* program){
+    printf("usage: %s FILE [--events] [--ticks FIRST:LAST] [--columns NAME,NAME...]\n", program);
+    printf("  (default)          summary: records, dropped records, and per column size, min, max and mean\n");
+    printf("  --events           every tick where someone scored or the game ended\n");
+    printf("  --ticks FIRST:LAST the records of these ticks (inclusive) as CSV\n");
+    printf("  --columns LIST     with --ticks, only these columns\n");
+}
+
+typedef struct ColumnSummary{
+    long bytes; //Encoded, with the size fields
+    int64_t min;
+    int64_t max;
+    double sum;
+} ColumnSummary;
+
+int printSummary(const TelemetryReader* reader, TelemetryRecord* records){
+    const TelemetryHeader* header = reader->header;
+    ColumnSummary columns[telemetryColumnCount];
+    for (int c = 0; c < telemetryColumnCount; c++) {
+        columns[c] = (ColumnSummary){0, INT64_MAX, INT64_MIN, 0};
+    }
+    long paddleHits = 0;
+    for (long b = 0; b < header->blockCount; b++) {
+        int count = readTelemetryBlock(reader, b, records);
+        if (count < 0) {
+            printf("block %ld is damaged\n", b);
+            return -1;
+        }
+        const unsigned char* data = (const unsigned char*) (reader->blocks[b] + 1);
+        long offset = 0;
+        for (int c = 0; c < telemetryColumnCount; c++) {
+            uint32_t size;
+            memcpy(&size, data + offset, 4);
+            columns[c].bytes += 4 + size;
+            offset += 4 + size;
+            for (int i = 0; i < count; i++) {
+                int64_t value = telemetryValue(&records[i], &telemetryColumns[c]);
+                columns[c].min = value < columns[c].min ? value : columns[c].min;
+                columns[c].max = value > columns[c].max ? value : columns[c].max;
+                columns[c].sum += (double) value;
+            }
+        }
+        for (int i = 0; i < count; i++) {
+            paddleHits += (records[i].event & TELEMETRY_PADDLE_HIT) != 0;
+        }
+    }
+
+    long recordCount = (long) header->recordCount;
+    printf("records:       %ld (%lld dropped)\n", recordCount, (long long) header->droppedRecords);
+    if (header->blockCount > 0) {
+        printf("ticks:         %lld to %lld\n", (long long) reader->blocks[0]->firstTick,
+               (long long) reader->blocks[header->blockCount - 1]->lastTick);
+    }
+    printf("blocks:        %lld\n", (long long) header->blockCount);
+    printf("file:          %zu bytes, %.2f bytes/record (%zu uncompressed)\n", reader->size,
+           recordCount > 0 ? (double) reader->size / recordCount : 0.0, sizeof(TelemetryRecord));
+    printf("paddle hits:   %ld\n", paddleHits);
+    printf("%-16s %10s %12s %12s %12s\n", "column", "bytes", "min", "max", "mean");
+    for (int c = 0; c < telemetryColumnCount; c++) {
+        if (recordCount == 0) {
+            printf("%-16s %10ld\n", telemetryColumns[c].name, columns[c].bytes);
+            continue;
+        }
+        printf("%-16s %10ld %12lld %12lld %12.2f\n", telemetryColumns[c].name, columns[c].bytes,
+               (long long) columns[c].min, (long long) columns[c].max, columns[c].sum / recordCount);
+    }
+    return 0;
+}
+
+int printEvents(const TelemetryReader* reader, TelemetryRecord* records){
+    printf("tick,event,playerScore,aiScore\n");
+    for (long b = 0; b < reader->header->blockCount; b++) {
+        int count = readTelemetryBlock(reader, b, records);
+        if (count < 0) {
+            printf("block %ld is damaged\n", b);
+            return -1;
+        }
+        for (int i = 0; i < count; i++) {
+            int event = records[i].event;
+            if ((event & (TELEMETRY_PLAYER_SCORED | TELEMETRY_AI_SCORED | TELEMETRY_GAME_OVER)) == 0) {
+                continue;
+            }
+            const char* name = event & TELEMETRY_GAME_OVER ? "game over"
+                               : event & TELEMETRY_PLAYER_SCORED ? "player scored" : "ai scored";
+            printf("%lld,%s,%d,%d\n", (long long) records[i].tick, name, records[i].playerScore, records[i].aiScore);
+        }
+    }
+    return 0;
+}
+
+int printTicks(const TelemetryReader* reader, TelemetryRecord* records, long first, long last, const char* columnList){
+    int selected[telemetryColumnCount];
+    int selectedCount = 0;
+    for (int c = 0; c < telemetryColumnCount; c++) {
+        if (columnList) {
+            //Whole names only: "ballX" doesn't pick "ballXSomething"
+            size_t length = strlen(telemetryColumns[c].name);
+            const char* found = columnList;
+            int match = 0;
+            while ((found = strstr(found, telemetryColumns[c].name)) != NULL) {
+                if ((found == columnList || found[-1] == ',') && (found[length] == ',' || found[length] == 0)) {
+                    match = 1;
+                    break;
+                }
+                found += length;
+            }
+            if (!match) {
+                continue;
+            }
+        }
+        selected[selectedCount++] = c;
+    }
+    if (selectedCount == 0) {
+        printf("no known columns in %s\n", columnList);
+        return -1;
+    }
+    for (int s = 0; s < selectedCount; s++) {
+        printf("%s%s", telemetryColumns[selected[s]].name, s + 1 < selectedCount ? "," : "\n");
+    }
+
+    for (long b = 0; b < reader->header->blockCount; b++) {
+        if (reader->blocks[b]->lastTick < first || reader->blocks[b]->firstTick > last) {
+            continue;
+        }
+        int count = readTelemetryBlock(reader, b, records);
+        if (count < 0) {
+            printf("block %ld is damaged\n", b);
+            return -1;
+        }
+        for (int i = 0; i < count; i++) {
+            if (records[i].tick < first || records[i].tick > last) {
+                continue;
+            }
+            for (int s = 0; s < selectedCount; s++) {
+                int64_t value = telemetryValue(&records[i], &telemetryColumns[selected[s]]);
+                printf("%lld%s", (long long) value, s + 1 < selectedCount ? "," : "\n");
+            }
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    const char* path = NULL;
+    int events = 0;
+    const char* ticks = NULL;
+    const char* columnList = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--events") == 0) {
+            events = 1;
+        } else if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            ticks = argv[++i];
+        } else if (strcmp(argv[i], "--columns") == 0 && i + 1 < argc) {
+            columnList = argv[++i];
+        } else if (argv[i][0] != '-' && !path) {
+            path = argv[i];
+        } else {
+            printUsage(argv[0]);
+            return strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+    if (!path) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    TelemetryReader reader;
+    if (openTelemetry(&reader, path) != 0) {
+        printf("can't read telemetry %s\n", path);
+        return 1;
+    }
+    TelemetryRecord* records = (TelemetryRecord*) malloc(sizeof(TelemetryRecord) * telemetryBlockRecords);
+    int result;
+    if (ticks) {
+        long first = 0;
+        long last = 0;
+        if (sscanf(ticks, "%ld:%ld", &first, &last) != 2) {
+            printf("--ticks needs FIRST:LAST\n");
+            result = -1;
+        } else {
+            result = printTicks(&reader, records, first, last, columnList);
+        }
+    } else if (events) {
+        result = printEvents(&reader, records);
+    } else {
+        result = printSummary(&reader, records);
+    }
+    free(records);
+    closeTelemetry(&reader);
+    return result == 0 ? 0 : 1;
+}
@@ -0,0 +1,297 @@
+// Batched text renderer, see text_renderer.h.
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "font_data.h"
+#include "text_renderer.h"
+
+//Atlas layout: glyphs in cells of glyphWidth + 1 by glyphHeight + 1 pixels, atlasColumns cells per row
+const int atlasColumns = 16;
+const int atlasCellWidth = glyphWidth + 1;
+const int atlasCellHeight = glyphHeight + 1;
+const int atlasWidth = 128;
+const int atlasHeight = 64;
+
+//The font constants are spliced in at init, see buildTextProgram
+const char* textVertexShader =
+    "layout(location = 0) in vec4 glyph;\n" //x, y, scale, atlas index
+    "layout(location = 1) in vec4 color;\n"
+    "uniform vec2 screenSize;\n"
+    "out vec2 glyphCoord;\n" //Font pixels from the top left corner of the glyph
+    "flat out ivec2 cellOrigin;\n"
+    "out vec4 vertexColor;\n"
+    "void main(){\n"
+    "    vec2 corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1));\n"
+    "    glyphCoord = corner * glyphSize;\n"
+    "    int index = int(glyph.w);\n"
+    "    cellOrigin = ivec2(index % atlasColumns, index / atlasColumns) * cellSize;\n"
+    "    vec2 pixel = glyph.xy + glyphCoord * glyph.z;\n"
+    "    gl_Position = vec4(pixel.x * 2.0 / screenSize.x - 1.0, 1.0 - pixel.y * 2.0 / screenSize.y, 0.0, 1.0);\n"
+    "    vertexColor = color;\n"
+    "}\n";
+
+const char* textFragmentShader =
+    "in vec2 glyphCoord;\n"
+    "flat in ivec2 cellOrigin;\n"
+    "in vec4 vertexColor;\n"
+    "uniform sampler2D atlas;\n"
+    "out vec4 fragColor;\n"
+    "void main(){\n"
+    //Exact texel lookup, no filtering, so glyphs come out pixel exact at whole number scales
+    "    float coverage = texelFetch(atlas, cellOrigin + ivec2(floor(glyphCoord)), 0).a;\n"
+    "    if (coverage < 0.5) {\n"
+    "        discard;\n"
+    "    }\n"
+    "    fragColor = vertexColor;\n"
+    "}\n";
+
+GLuint buildTextProgram(){
+    char header[256];
+    snprintf(header, sizeof(header),
+             "#version 330 core\n"
+             "const vec2 glyphSize = vec2(%d.0, %d.0);\n"
+             "const ivec2 cellSize = ivec2(%d, %d);\n"
+             "const int atlasColumns = %d;\n",
+             glyphWidth, glyphHeight, atlasCellWidth, atlasCellHeight, atlasColumns);
+    char vertex[2048];
+    char fragment[2048];
+    snprintf(vertex, sizeof(vertex), "%s%s", header, textVertexShader);
+    snprintf(fragment, sizeof(fragment), "%s%s", header, textFragmentShader);
+    return buildShaderProgram(vertex, fragment);
+}
+
+GLuint bakeAtlas(){
+    //White texels, the glyph bitmap goes in alpha
+    static unsigned char pixels[atlasHeight][atlasWidth][4];
+    memset(pixels, 0, sizeof(pixels));
+    for (int glyph = 0; glyph < glyphCount; glyph++) {
+        int cellX = (glyph % atlasColumns) * atlasCellWidth;
+        int cellY = (glyph / atlasColumns) * atlasCellHeight;
+        for (int row = 0; row < glyphHeight; row++) {
+            for (int column = 0; column < glyphWidth; column++) {
+                unsigned char* texel = pixels[cellY + row][cellX + column];
+                texel[0] = texel[1] = texel[2] = 255;
+                texel[3] = glyphPixel((char) (firstGlyph + glyph), column, row) ? 255 : 0;
+            }
+        }
+    }
+
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, atlasWidth, atlasHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return texture;
+}
+
+int initTextRenderer(TextRenderer* renderer, int screenW, int screenH, int forceImmediate){
+    memset(renderer, 0, sizeof(TextRenderer));
+    renderer->screenW = (float) screenW;
+    renderer->screenH = (float) screenH;
+    renderer->texture = bakeAtlas();
+    renderer->glyphCapacity = 256;
+    renderer->glyphs = (GlyphInstance*) malloc(sizeof(GlyphInstance) * renderer->glyphCapacity);
+    for (int i = 0; i < textCacheSize; i++) {
+        renderer->cache[i].glyphs = (GlyphInstance*) malloc(sizeof(GlyphInstance) * textCacheLength);
+        renderer->cache[i].lastUsed = -1;
+    }
+
+    renderer->mode = TEXT_RENDERER_IMMEDIATE;
+    if (!forceImmediate && glf.loaded) {
+        renderer->program = buildTextProgram();
+    }
+    if (renderer->program != 0) {
+        renderer->screenSizeLocation = glf.GetUniformLocation(renderer->program, "screenSize");
+        renderer->atlasLocation = glf.GetUniformLocation(renderer->program, "atlas");
+        glf.GenVertexArrays(1, &renderer->vertexArray);
+        glf.GenBuffers(1, &renderer->buffer);
+        renderer->mode = TEXT_RENDERER_INSTANCED;
+    }
+    return renderer->mode;
+}
+
+void destroyTextRenderer(TextRenderer* renderer){
+    if (renderer->mode == TEXT_RENDERER_INSTANCED) {
+        glf.DeleteBuffers(1, &renderer->buffer);
+        glf.DeleteVertexArrays(1, &renderer->vertexArray);
+        glf.DeleteProgram(renderer->program);
+    }
+    glDeleteTextures(1, &renderer->texture);
+    for (int i = 0; i < textCacheSize; i++) {
+        free(renderer->cache[i].glyphs);
+    }
+    free(renderer->glyphs);
+    memset(renderer, 0, sizeof(TextRenderer));
+}
+
+void beginText(TextRenderer* renderer){
+    renderer->glyphCount = 0;
+    renderer->frame++;
+    renderer->cacheHits = 0;
+    renderer->cacheMisses = 0;
+    renderer->drawCalls = 0;
+}
+
+int layoutText(const char* text, int x, int y, int scale, Color color, GlyphInstance* glyphs){
+    //One instance per visible character. Spaces and characters outside the font only advance.
+    int count = 0;
+    int top = y - glyphBaseline * scale;
+    for (int i = 0; text[i]; i++) {
+        int glyph = text[i] - firstGlyph;
+        if (glyph <= 0 || glyph >= glyphCount) {
+            continue;
+        }
+        GlyphInstance* instance = &glyphs[count++];
+        instance->x = (float) (x + i * glyphAdvance * scale);
+        instance->y = (float) top;
+        instance->scale = (float) scale;
+        instance->glyph = (float) glyph;
+        instance->r = color.r;
+        instance->g = color.g;
+        instance->b = color.b;
+        instance->a = 255;
+    }
+    return count;
+}
+
+GlyphInstance* reserveGlyphs(TextRenderer* renderer, int count){
+    if (renderer->glyphCount + count > renderer->glyphCapacity) {
+        while (renderer->glyphCount + count > renderer->glyphCapacity) {
+            renderer->glyphCapacity *= 2;
+        }
+        renderer->glyphs = (GlyphInstance*) realloc(renderer->glyphs, sizeof(GlyphInstance) * renderer->glyphCapacity);
+    }
+    return &renderer->glyphs[renderer->glyphCount];
+}
+
+void drawText(TextRenderer* renderer, const char* text, int x, int y, int scale, Color color){
+    int length = (int) strlen(text);
+    if (length >= textCacheLength) {
+        renderer->glyphCount += layoutText(text, x, y, scale, color, reserveGlyphs(renderer, length));
+        return;
+    }
+
+    TextCacheEntry* oldest = &renderer->cache[0];
+    for (int i = 0; i < textCacheSize; i++) {
+        TextCacheEntry* entry = &renderer->cache[i];
+        if (entry->lastUsed >= 0 && entry->x == x && entry->y == y && entry->scale == scale &&
+            entry->color.r == color.r && entry->color.g == color.g && entry->color.b == color.b &&
+            strcmp(entry->text, text) == 0) {
+            entry->lastUsed = renderer->frame;
+            memcpy(reserveGlyphs(renderer, entry->glyphCount), entry->glyphs, sizeof(GlyphInstance) * entry->glyphCount);
+            renderer->glyphCount += entry->glyphCount;
+            renderer->cacheHits++;
+            return;
+        }
+        if (entry->lastUsed < oldest->lastUsed) {
+            oldest = entry;
+        }
+    }
+
+    renderer->cacheMisses++;
+    memcpy(oldest->text, text, length + 1);
+    oldest->x = x;
+    oldest->y = y;
+    oldest->scale = scale;
+    oldest->color = color;
+    oldest->glyphCount = layoutText(text, x, y, scale, color, oldest->glyphs);
+    oldest->lastUsed = renderer->frame;
+    memcpy(reserveGlyphs(renderer, oldest->glyphCount), oldest->glyphs, sizeof(GlyphInstance) * oldest->glyphCount);
+    renderer->glyphCount += oldest->glyphCount;
+}
+
+void drawTextCentered(TextRenderer* renderer, const char* text, int x, int y, int scale, Color color){
+    drawText(renderer, text, x - textWidth(text, scale) / 2, y, scale, color);
+}
+
+void drawNumber(TextRenderer* renderer, long value, int x, int y, int scale, Color color){
+    char text[24];
+    snprintf(text, sizeof(text), "%ld", value);
+    drawText(renderer, text, x, y, scale, color);
+}
+
+void flushTextImmediate(TextRenderer* renderer){
+    float scaleX = 2.0f / renderer->screenW;
+    float scaleY = 2.0f / renderer->screenH;
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, renderer->texture);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+    glEnable(GL_ALPHA_TEST);
+    glAlphaFunc(GL_GREATER, 0.5f);
+
+    glBegin(GL_QUADS);
+    for (int i = 0; i < renderer->glyphCount; i++) {
+        const GlyphInstance* glyph = &renderer->glyphs[i];
+        int index = (int) glyph->glyph;
+        float u1 = (float) ((index % atlasColumns) * atlasCellWidth) / atlasWidth;
+        float v1 = (float) ((index / atlasColumns) * atlasCellHeight) / atlasHeight;
+        float u2 = u1 + (float) glyphWidth / atlasWidth;
+        float v2 = v1 + (float) glyphHeight / atlasHeight;
+        float x1 = glyph->x * scaleX - 1.0f;
+        float y1 = 1.0f - glyph->y * scaleY;
+        float x2 = (glyph->x + glyphWidth * glyph->scale) * scaleX - 1.0f;
+        float y2 = 1.0f - (glyph->y + glyphHeight * glyph->scale) * scaleY;
+        glColor4ub(glyph->r, glyph->g, glyph->b, glyph->a);
+        glTexCoord2f(u1, v1);
+        glVertex2f(x1, y1);
+        glTexCoord2f(u2, v1);
+        glVertex2f(x2, y1);
+        glTexCoord2f(u2, v2);
+        glVertex2f(x2, y2);
+        glTexCoord2f(u1, v2);
+        glVertex2f(x1, y2);
+    }
+    glEnd();
+
+    glDisable(GL_ALPHA_TEST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glDisable(GL_TEXTURE_2D);
+}
+
+void flushText(TextRenderer* renderer){
+    if (renderer->glyphCount == 0) {
+        return;
+    }
+    renderer->drawCalls++;
+    if (renderer->mode == TEXT_RENDERER_IMMEDIATE) {
+        flushTextImmediate(renderer);
+        renderer->glyphCount = 0;
+        return;
+    }
+
+    glf.BindVertexArray(renderer->vertexArray);
+    glf.BindBuffer(GL_ARRAY_BUFFER, renderer->buffer);
+    if (renderer->glyphCount > renderer->bufferCapacity) {
+        renderer->bufferCapacity = renderer->glyphCapacity;
+    }
+    //Orphan and refill, text is a few hundred bytes a frame
+    glf.BufferData(GL_ARRAY_BUFFER, sizeof(GlyphInstance) * renderer->bufferCapacity, NULL, GL_STREAM_DRAW);
+    glf.BufferSubData(GL_ARRAY_BUFFER, 0, sizeof(GlyphInstance) * renderer->glyphCount, renderer->glyphs);
+    glf.EnableVertexAttribArray(0);
+    glf.VertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(GlyphInstance), (const void*) offsetof(GlyphInstance, x));
+    glf.VertexAttribDivisor(0, 1);
+    glf.EnableVertexAttribArray(1);
+    glf.VertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(GlyphInstance), (const void*) offsetof(GlyphInstance, r));
+    glf.VertexAttribDivisor(1, 1);
+
+    glf.UseProgram(renderer->program);
+    glf.Uniform2f(renderer->screenSizeLocation, renderer->screenW, renderer->screenH);
+    glf.ActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, renderer->texture);
+    glf.Uniform1i(renderer->atlasLocation, 0);
+    glf.DrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, renderer->glyphCount);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glf.UseProgram(0);
+    glf.BindBuffer(GL_ARRAY_BUFFER, 0);
+    glf.BindVertexArray(0);
+    renderer->glyphCount = 0;
+}
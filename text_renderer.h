@@ -0,0 +1,83 @@
+// Batched text renderer.
+// The bitmap font is baked into a glyph atlas texture once. Strings are laid out into glyph instances (pixel
+// position, scale, glyph index, color) that are cached per string, and every glyph of a frame is drawn with one
+// instanced call. Contexts older than 3.3 get an immediate mode fallback that draws textured quads from the same
+// atlas in a single glBegin/glEnd.
+
+#ifndef PONG_TEXT_RENDERER_H
+#define PONG_TEXT_RENDERER_H
+
+#include "color.h"
+#include "gl_functions.h"
+
+enum TextRendererMode{
+    TEXT_RENDERER_IMMEDIATE = 0,
+    TEXT_RENDERER_INSTANCED = 1
+};
+
+typedef struct GlyphInstance{
+    float x; //Pixels, top left corner of the glyph cell
+    float y;
+    float scale; //Pixels per font pixel
+    float glyph; //Index into the atlas
+    unsigned char r;
+    unsigned char g;
+    unsigned char b;
+    unsigned char a;
+} GlyphInstance;
+
+const int textCacheSize = 32; //Laid out strings kept between frames
+const int textCacheLength = 64; //Longest string that is cached, longer ones are laid out every time
+
+typedef struct TextCacheEntry{
+    char text[textCacheLength];
+    int x;
+    int y;
+    int scale;
+    Color color;
+    int glyphCount;
+    GlyphInstance* glyphs; //textCacheLength entries
+    long lastUsed; //Frame the entry was last hit, the oldest one is replaced on a miss
+} TextCacheEntry;
+
+typedef struct TextRenderer{
+    int mode; //TextRendererMode
+    float screenW; //Size of the pixel space that is mapped onto the viewport
+    float screenH;
+    GLuint texture;
+    GLuint program;
+    GLint screenSizeLocation;
+    GLint atlasLocation;
+    GLuint vertexArray;
+    GLuint buffer;
+    int bufferCapacity; //Glyphs the GPU buffer holds
+    GlyphInstance* glyphs; //Glyphs queued this frame
+    int glyphCount;
+    int glyphCapacity;
+    TextCacheEntry cache[textCacheSize];
+    long frame;
+    int cacheHits; //Since beginText, for stats
+    int cacheMisses;
+    int drawCalls;
+} TextRenderer;
+
+//Bakes the atlas and sets up the pipeline for a pixel space of screenW x screenH. Returns the mode it picked.
+int initTextRenderer(TextRenderer* renderer, int screenW, int screenH, int forceImmediate);
+void destroyTextRenderer(TextRenderer* renderer);
+
+//Starts a new frame
+void beginText(TextRenderer* renderer);
+
+//Queues text with its left end at x and its baseline at y, in pixels. scale is pixels per font pixel.
+void drawText(TextRenderer* renderer, const char* text, int x, int y, int scale, Color color);
+
+//Same as drawText, centered horizontally on x
+void drawTextCentered(TextRenderer* renderer, const char* text, int x, int y, int scale, Color color);
+
+//Queues a number, e.g. a score or a frame rate
+void drawNumber(TextRenderer* renderer, long value, int x, int y, int scale, Color color);
+
+//Draws every glyph queued since the last flush in one call
+void flushText(TextRenderer* renderer);
+
+#endif //PONG_TEXT_RENDERER_H
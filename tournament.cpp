@@ -0,0 +1,133 @@
+// Tournaments between AI variants, see tournament.h.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "game_config.h"
+#include "simulation_kernels.h"
+#include "tournament.h"
+
+//The field seen from the right: the ball and paddles mirrored left to right, so the AI, which always plays the
+//left paddle, can play the right one. The mirrored ball's left edge is where the real ball's right edge is, so the
+//distance to the paddle stays exact. The reset position maps onto itself, so the AI still notices resets.
+Global mirrorState(const Global* state){
+    Global mirrored = *state;
+    if (state->ballPosition.x != initialBallPosition.x || state->ballPosition.y != initialBallPosition.y) {
+        mirrored.ballPosition.x = screenWidth - state->ballPosition.x - ballSideLength;
+    }
+    mirrored.ballDirection.x = -state->ballDirection.x;
+    mirrored.aiPaddlePosition = (Point){screenWidth - state->playerPaddlePosition.x - paddleWidth,
+                                        state->playerPaddlePosition.y};
+    mirrored.playerPaddlePosition = (Point){screenWidth - state->aiPaddlePosition.x - paddleWidth,
+                                            state->aiPaddlePosition.y};
+    mirrored.playerScore = state->aiScore;
+    mirrored.aiScore = state->playerScore;
+    return mirrored;
+}
+
+//Every match gets its own seeds and its own offset into the scripted input
+unsigned int matchSeed(long match, unsigned int salt){
+    unsigned int seed = (unsigned int) match * 2654435761u ^ salt;
+    seed ^= seed >> 16;
+    return seed * 2246822519u + 1;
+}
+
+long playTournamentMatch(Global* state, const AiParams* variant, const AiParams* opponent, long match, long maxTicks){
+    AiState left;
+    AiState right;
+    initAi(&left, variant, matchSeed(match, 0x1234567u));
+    if (opponent) {
+        initAi(&right, opponent, matchSeed(match, 0x89abcdefu));
+    }
+    long phase = matchSeed(match, 0x5bd1e995u) % 100000;
+    initArenaState(state, StandardArena::get());
+
+    //Same order as a tick of the game: the scripted player moves first (the mouse), then the ball, then the AIs.
+    //Both AIs see the ball after it moved, so neither side gets to react a tick earlier than the other.
+    long tick = 0;
+    while (!state->gameOver && tick < maxTicks) {
+        if (!opponent) {
+            portableMouse(state, scriptedPlayerY(tick + phase));
+        }
+        portableUpdateBall(state);
+        updatePredictiveAI(state, &left);
+        if (opponent) {
+            Global mirrored = mirrorState(state);
+            updatePredictiveAI(&mirrored, &right);
+            state->playerPaddlePosition.y = mirrored.aiPaddlePosition.y;
+        }
+        if (state->playerScore >= winningScore || state->aiScore >= winningScore) {
+            state->gameOver = 1;
+        }
+        tick++;
+    }
+    return tick;
+}
+
+TournamentCell* tournamentCell(const Tournament* tournament, int variant, int opponent){
+    return &tournament->cells[variant * tournament->opponentCount + opponent];
+}
+
+typedef struct TournamentRun{
+    const Tournament* tournament;
+    TournamentCell* workerCells; //One table per worker
+} TournamentRun;
+
+void playTournamentTask(long index, int worker, void* context){
+    TournamentRun* run = (TournamentRun*) context;
+    const Tournament* tournament = run->tournament;
+    long pairing = index / tournament->matchesPerPairing;
+    int variant = (int) (pairing / tournament->opponentCount);
+    int opponent = (int) (pairing % tournament->opponentCount);
+
+    //Against another variant, every other match swaps the paddles: the serve starts a tick closer to the right
+    //paddle than to the left one, so whoever plays the left paddle has a small edge
+    const AiParams* variantParams = &tournament->variants[variant];
+    const AiParams* opponentParams = opponent > 0 ? &tournament->variants[opponent - 1] : NULL;
+    int swapped = opponentParams && index % 2 == 1;
+    Global state;
+    long ticks = playTournamentMatch(&state, swapped ? opponentParams : variantParams,
+                                     swapped ? variantParams : opponentParams, index, tournament->maxTicks);
+    int points = swapped ? state.playerScore : state.aiScore;
+    int pointsAgainst = swapped ? state.aiScore : state.playerScore;
+
+    TournamentCell* cell = &run->workerCells[(long) worker * tournament->variantCount * tournament->opponentCount
+                                             + pairing];
+    cell->matches++;
+    cell->wins += points >= winningScore;
+    cell->losses += pointsAgainst >= winningScore;
+    cell->points += points;
+    cell->pointsAgainst += pointsAgainst;
+    cell->ticks += ticks;
+}
+
+void runTournament(Tournament* tournament){
+    tournament->opponentCount = tournament->variantCount + 1;
+    int threads = tournament->threads > 0 ? tournament->threads : hardwareThreads();
+    long cellCount = (long) tournament->variantCount * tournament->opponentCount;
+    tournament->cells = (TournamentCell*) calloc(cellCount, sizeof(TournamentCell));
+
+    TournamentRun run;
+    run.tournament = tournament;
+    run.workerCells = (TournamentCell*) calloc(cellCount * threads, sizeof(TournamentCell));
+    tournament->pool = runWorkPool(cellCount * tournament->matchesPerPairing, threads, playTournamentTask, &run);
+
+    for (int worker = 0; worker < threads; worker++) {
+        for (long i = 0; i < cellCount; i++) {
+            const TournamentCell* from = &run.workerCells[worker * cellCount + i];
+            TournamentCell* to = &tournament->cells[i];
+            to->matches += from->matches;
+            to->wins += from->wins;
+            to->losses += from->losses;
+            to->points += from->points;
+            to->pointsAgainst += from->pointsAgainst;
+            to->ticks += from->ticks;
+        }
+    }
+    free(run.workerCells);
+}
+
+void freeTournament(Tournament* tournament){
+    free(tournament->cells);
+    tournament->cells = NULL;
+}
@@ -0,0 +1,47 @@
+// Tournaments between AI variants.
+// Plays a grid of pairings, every variant against every opponent: the scripted player on the right paddle, then
+// each variant again. Against a variant, each side plays the left paddle in half the matches (the AI is mirrored
+// to play the right one), since the field isn't quite symmetric. Every pairing gets the same number of
+// matches. Each match runs on a Global of its own, through the kernels that take a state (portableUpdateBall,
+// updatePredictiveAI), and gets its own seeds, so no match touches global and any number of them run at once.
+// Matches are spread over the cores with runWorkPool. Each worker adds its results to tables of its own, which are
+// summed once every worker is done, so recording a result never takes a lock.
+
+#ifndef PONG_TOURNAMENT_H
+#define PONG_TOURNAMENT_H
+
+#include "ai.h"
+#include "work_pool.h"
+
+typedef struct TournamentCell{
+    long matches;
+    long wins; //Matches the row variant won
+    long losses;
+    long points; //Scored by the row variant
+    long pointsAgainst;
+    long ticks;
+} TournamentCell;
+
+typedef struct Tournament{
+    const AiParams* variants;
+    int variantCount;
+    int opponentCount; //variantCount + 1, opponent 0 is the scripted player
+    long matchesPerPairing;
+    long maxTicks; //Matches still running after this many ticks are left unfinished
+    int threads; //0 for one per hardware thread
+    TournamentCell* cells; //variantCount x opponentCount, row major, filled in by runTournament
+    WorkPoolStats pool;
+} Tournament;
+
+//Plays every pairing and fills in tournament->cells. Free them with freeTournament.
+void runTournament(Tournament* tournament);
+void freeTournament(Tournament* tournament);
+
+//Plays one match of variant on the left paddle (the AI side of state) against opponent (NULL for the scripted
+//player) on the right, from the initial game state. Returns the ticks played.
+long playTournamentMatch(Global* state, const AiParams* variant, const AiParams* opponent, long match, long maxTicks);
+
+//The cell of variant against opponent
+TournamentCell* tournamentCell(const Tournament* tournament, int variant, int opponent);
+
+#endif //PONG_TOURNAMENT_H
@@ -0,0 +1,85 @@
+// Vectorized environment, see vector_env.h.
+
+#include <stdlib.h>
+
+#include "vector_env.h"
+
+void initVectorEnv(VectorEnv* env, int count, int maxTicks){
+    initBatchWorld(&env->world, count);
+    env->count = count;
+    env->maxTicks = maxTicks;
+    env->playerScore = (int*) calloc(count, sizeof(int));
+    env->aiScore = (int*) calloc(count, sizeof(int));
+    env->episodeReturn = (int*) calloc(count, sizeof(int));
+}
+
+void freeVectorEnv(VectorEnv* env){
+    freeBatchWorld(&env->world);
+    free(env->playerScore);
+    free(env->aiScore);
+    free(env->episodeReturn);
+    env->playerScore = NULL;
+    env->aiScore = NULL;
+    env->episodeReturn = NULL;
+}
+
+void writeObservation(const BatchWorld* world, int game, float* observation){
+    const float fieldX = 1.0f / screenWidth;
+    const float fieldY = 1.0f / screenHeight;
+    const float speed = 1.0f / initialBallSpeed;
+    const float score = 1.0f / winningScore;
+    observation[0] = world->ballX[game] * fieldX;
+    observation[1] = world->ballY[game] * fieldY;
+    observation[2] = (float) world->ballDirectionX[game];
+    observation[3] = (float) world->ballDirectionY[game];
+    observation[4] = world->ballSpeed[game] * speed;
+    observation[5] = world->playerPaddleY[game] * fieldY;
+    observation[6] = world->aiPaddleY[game] * fieldY;
+    observation[7] = world->playerScore[game] * score;
+    observation[8] = world->aiScore[game] * score;
+}
+
+void resetVectorEnv(VectorEnv* env, float* observations){
+    for (int game = 0; game < env->count; game++) {
+        resetBatchLane(&env->world, game);
+        env->playerScore[game] = 0;
+        env->aiScore[game] = 0;
+        env->episodeReturn[game] = 0;
+        writeObservation(&env->world, game, observations + game * envObservationSize);
+    }
+}
+
+int stepVectorEnv(VectorEnv* env, const int* actions, const EnvStep* step){
+    BatchWorld* world = &env->world;
+    stepBatchWorld(world, actions);
+
+    int ended = 0;
+    for (int game = 0; game < env->count; game++) {
+        int reward = (world->playerScore[game] - env->playerScore[game]) - (world->aiScore[game] - env->aiScore[game]);
+        env->episodeReturn[game] += reward;
+        int terminated = world->gameOver[game];
+        int truncated = !terminated && env->maxTicks > 0 && world->ticks[game] >= env->maxTicks;
+        if (terminated || truncated) {
+            if (step->episodeReturns) {
+                step->episodeReturns[game] = env->episodeReturn[game];
+            }
+            resetBatchLane(world, game);
+            env->episodeReturn[game] = 0;
+            ended++;
+        }
+        env->playerScore[game] = world->playerScore[game];
+        env->aiScore[game] = world->aiScore[game];
+
+        if (step->rewards) {
+            step->rewards[game] = (float) reward;
+        }
+        if (step->terminated) {
+            step->terminated[game] = (unsigned char) terminated;
+        }
+        if (step->truncated) {
+            step->truncated[game] = (unsigned char) truncated;
+        }
+        writeObservation(world, game, step->observations + game * envObservationSize);
+    }
+    return ended;
+}
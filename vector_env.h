@@ -0,0 +1,49 @@
+// Vectorized environment for training paddle agents.
+// Steps a batch of games in one call, Gym style: the agent plays the player paddle, its action is the mouse y
+// coordinate for the tick (what mouse() gets from GLUT), and the AI plays the other side with updateAI().
+// Games run on a BatchWorld, so a step is the same branch-free SIMD kernel as pong_headless --batch.
+// Observations, rewards and done flags are written straight into buffers the caller owns, and a step never
+// allocates. Games that end are put back to the initial state within the same step (auto-reset): their done flag
+// is set and their observation is already the first one of the next game.
+
+#ifndef PONG_VECTOR_ENV_H
+#define PONG_VECTOR_ENV_H
+
+#include "batch_world.h"
+
+//Floats per observation, one observation per game, back to back:
+//ball x, ball y (as fractions of the field), ball direction x, y (-1 or 1), ball speed (in initial speeds),
+//player paddle y, AI paddle y (top edges, as fractions of the field height), player score, AI score (as fractions
+//of winningScore)
+const int envObservationSize = 9;
+
+typedef struct VectorEnv{
+    BatchWorld world;
+    int count;
+    int maxTicks; //Games still running after this many ticks are truncated and reset, 0 for no limit
+    int* playerScore; //Scores before the step, to work out rewards
+    int* aiScore;
+    int* episodeReturn; //Reward collected so far in the current game
+} VectorEnv;
+
+//Where a step writes its results. Every buffer holds one entry per game (envObservationSize floats for
+//observations). Any of them but observations can be NULL.
+typedef struct EnvStep{
+    float* observations;
+    float* rewards; //+1 when the player scores, -1 when the AI does
+    unsigned char* terminated; //The game was won this step
+    unsigned char* truncated; //The game hit maxTicks this step
+    int* episodeReturns; //Total reward of a game that ended this step, left alone otherwise
+} EnvStep;
+
+void initVectorEnv(VectorEnv* env, int count, int maxTicks);
+void freeVectorEnv(VectorEnv* env);
+
+//Puts every game back to the initial state and writes the first observations
+void resetVectorEnv(VectorEnv* env, float* observations);
+
+//Advances every game by one tick with actions (one mouse y per game), resets the games that ended and writes
+//the results to step. Returns the number of games that ended.
+int stepVectorEnv(VectorEnv* env, const int* actions, const EnvStep* step);
+
+#endif //PONG_VECTOR_ENV_H
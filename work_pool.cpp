@@ -0,0 +1,112 @@
+// Work stealing thread pool, see work_pool.h.
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "work_pool.h"
+
+//The part of the range a worker has left, [begin, end). Padded to a cache line so workers taking from their own
+//queue don't slow each other down. C++11 allocators ignore the alignment, so the queues are placed by hand.
+typedef struct alignas(64) WorkQueue{
+    std::mutex lock;
+    long begin;
+    long end;
+} WorkQueue;
+
+typedef struct WorkPool{
+    WorkQueue* queues;
+    int threads;
+    WorkFunction work;
+    void* context;
+    std::atomic<long> steals;
+} WorkPool;
+
+//Takes the next index of the worker's own queue, -1 when it is empty
+long takeOwn(WorkQueue* queue){
+    std::lock_guard<std::mutex> guard(queue->lock);
+    return queue->begin < queue->end ? queue->begin++ : -1;
+}
+
+//Moves the back half of another worker's queue into the worker's own. Returns 0 if every queue was empty.
+int stealWork(WorkPool* pool, int worker){
+    WorkQueue* own = &pool->queues[worker];
+    for (int i = 1; i < pool->threads; i++) {
+        WorkQueue* victim = &pool->queues[(worker + i) % pool->threads];
+        long begin;
+        long end;
+        {
+            std::lock_guard<std::mutex> guard(victim->lock);
+            long left = victim->end - victim->begin;
+            if (left <= 0) {
+                continue;
+            }
+            //A single index left goes too, its owner may be stuck on a long task
+            end = victim->end;
+            begin = end - (left + 1) / 2;
+            victim->end = begin;
+        }
+        std::lock_guard<std::mutex> guard(own->lock);
+        own->begin = begin;
+        own->end = end;
+        pool->steals++;
+        return 1;
+    }
+    return 0;
+}
+
+void runWorker(WorkPool* pool, int worker){
+    //Indices are never added once the pool is running, so when nothing is left to steal the work is done
+    while (true) {
+        long index = takeOwn(&pool->queues[worker]);
+        if (index < 0) {
+            if (!stealWork(pool, worker)) {
+                return;
+            }
+            continue;
+        }
+        pool->work(index, worker, pool->context);
+    }
+}
+
+WorkPoolStats runWorkPool(long count, int threads, WorkFunction work, void* context){
+    threads = threads > 0 ? threads : hardwareThreads();
+    void* memory = malloc(sizeof(WorkQueue) * threads + alignof(WorkQueue));
+    WorkQueue* queues = (WorkQueue*) (((uintptr_t) memory + alignof(WorkQueue) - 1)
+                                      & ~(uintptr_t) (alignof(WorkQueue) - 1));
+    for (int i = 0; i < threads; i++) {
+        new (&queues[i]) WorkQueue();
+        queues[i].begin = count * i / threads;
+        queues[i].end = count * (i + 1) / threads;
+    }
+    WorkPool pool;
+    pool.queues = queues;
+    pool.threads = threads;
+    pool.work = work;
+    pool.context = context;
+    pool.steals = 0;
+
+    std::vector<std::thread> workers;
+    for (int i = 1; i < threads; i++) {
+        workers.push_back(std::thread(runWorker, &pool, i));
+    }
+    runWorker(&pool, 0);
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+    for (int i = 0; i < threads; i++) {
+        queues[i].~WorkQueue();
+    }
+    free(memory);
+    return (WorkPoolStats){threads, pool.steals.load()};
+}
+
+int hardwareThreads(){
+    unsigned int threads = std::thread::hardware_concurrency();
+    return threads > 0 ? (int) threads : 1;
+}
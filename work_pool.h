@@ -0,0 +1,25 @@
+// Work stealing thread pool.
+// Runs a function over a range of indices on several threads. The range is split evenly between the workers up
+// front, each worker takes indices from the front of its own part, and a worker that runs out steals the back
+// half of what another worker has left. Work is only ever moved when a worker is idle, so uneven task lengths
+// (matches that end after 2000 ticks or after a million) still keep every thread busy to the end.
+
+#ifndef PONG_WORK_POOL_H
+#define PONG_WORK_POOL_H
+
+//Called once per index, worker is the calling thread's number in [0, threads)
+typedef void (*WorkFunction)(long index, int worker, void* context);
+
+typedef struct WorkPoolStats{
+    int threads;
+    long steals; //Times a worker took work from another one
+} WorkPoolStats;
+
+//Runs work for every index in [0, count) on threads threads (the calling thread is one of them) and returns once
+//all of them are done. threads <= 0 uses one per hardware thread.
+WorkPoolStats runWorkPool(long count, int threads, WorkFunction work, void* context);
+
+//Number of hardware threads, at least 1
+int hardwareThreads();
+
+#endif //PONG_WORK_POOL_H